@@ -0,0 +1,116 @@
+#include <AutonomyInterface.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static_assert(AUTONOMY_DRIVE_MOTORS == NUM_DRIVE_MOTORS, "AutonomyShared.h drive motor count out of date");
+static_assert(AUTONOMY_MANIPULATOR_JOINTS == NUM_MANIPULATOR_JOINTS, "AutonomyShared.h manipulator joint count out of date");
+
+AutonomyInterface::AutonomyInterface(Safety *safe)
+{
+	shared = nullptr;
+	int fd = shm_open(autonomySharedName, O_CREAT | O_RDWR, 0660);
+	if(fd >= 0)
+	{
+		if(ftruncate(fd, sizeof(AutonomyShared)) == 0)
+		{
+			void *mapping = mmap(nullptr, sizeof(AutonomyShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if(mapping != MAP_FAILED)
+			{
+				// Start from an empty mailbox so a stale command from a previous run is never followed
+				shared = (AutonomyShared *)mapping;
+				memset((void *)shared, 0, sizeof(AutonomyShared));
+				shared->magic = autonomyMagic;
+				shared->version = autonomyVersion;
+			}
+		}
+		close(fd);
+	}
+	if(shared == nullptr)
+		std::cout << "AutonomyInterface: shared memory unavailable, autonomy disabled" << std::endl;
+
+	this->safety = safe;
+	reset();
+}
+
+AutonomyInterface::~AutonomyInterface()
+{
+	if(shared != nullptr)
+		munmap(shared, sizeof(AutonomyShared));
+}
+
+void AutonomyInterface::update()
+{
+	if(shared == nullptr) return;
+
+	// Read the latest command; keep the previous one if a write was in progress
+	AutonomyCommandData latest;
+	if(seqlockRead(shared->command, latest))
+		command = latest;
+
+	uint64_t now = monotonicMicros();
+	uint32_t lease = std::min(command.leaseMicros, maxLeaseMicros);
+	commandValid = (command.timestampMicros <= now) && ((now - command.timestampMicros) <= lease);
+
+	if(!stateStaged) return;
+	stateStaged = false;
+
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+		state.driveCurrent[i] = safety->getDriveCurrent(i);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		state.manipulatorCurrent[i] = safety->getManipulatorCurrent(i);
+	state.relayEnabled = safety->getRelayEnabled();
+	state.timestampMicros = now;
+	seqlockWrite(shared->state, state);
+}
+
+void AutonomyInterface::reset()
+{
+	memset(&command, 0, sizeof(command));
+	memset(&state, 0, sizeof(state));
+	commandValid = false;
+	stateStaged = false;
+}
+
+bool AutonomyInterface::getDriveCommand(float &forwardSpeed, float &turnSpeed)
+{
+	if(!commandValid || !(command.flags & AutonomyDriveCommand)) return false;
+
+	// The autonomy process is not trusted: NaN passes through constrain() and would reach the motors
+	if(!std::isfinite(command.forwardSpeed) || !std::isfinite(command.turnSpeed)) return false;
+	forwardSpeed = constrain(command.forwardSpeed, -1, 1);
+	turnSpeed = constrain(command.turnSpeed, -1, 1);
+	return true;
+}
+
+bool AutonomyInterface::getJointCommand(float jointPosition[NUM_MANIPULATOR_JOINTS])
+{
+	if(!commandValid || !(command.flags & AutonomyJointCommand)) return false;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		if(!std::isfinite(command.jointPosition[i])) return false;
+
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		jointPosition[i] = constrain(command.jointPosition[i], manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
+	return true;
+}
+
+void AutonomyInterface::setDriveState(const uint32_t encoder[NUM_DRIVE_MOTORS], const int motorSpeed[NUM_DRIVE_MOTORS], float distanceTravelled, bool following)
+{
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+	{
+		state.encoder[i] = encoder[i];
+		state.motorSpeed[i] = motorSpeed[i];
+	}
+	state.distanceTravelled = distanceTravelled;
+	state.activeCommands = following ? (state.activeCommands | AutonomyDriveCommand) : (state.activeCommands & ~AutonomyDriveCommand);
+	stateStaged = true;
+}
+
+void AutonomyInterface::setManipulatorState(const float jointPosition[NUM_MANIPULATOR_JOINTS], bool following)
+{
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		state.jointPosition[i] = jointPosition[i];
+	state.activeCommands = following ? (state.activeCommands | AutonomyJointCommand) : (state.activeCommands & ~AutonomyJointCommand);
+	stateStaged = true;
+}
@@ -0,0 +1,40 @@
+#ifndef SRC_AUTONOMYINTERFACE_H_
+#define SRC_AUTONOMYINTERFACE_H_
+
+#include <Constants.h>
+#include <Safety.h>
+#include <AutonomyShared.h>
+
+/*
+ * Robot side of the shared memory interface to an on-board autonomy process (see AutonomyShared.h).
+ * update() is called once per robot loop: it reads the latest command from the mailbox and publishes
+ * the state staged by Drive and Manipulator, plus the Safety currents and relay state.
+ * If the shared memory cannot be created, commands are never valid and nothing is published.
+ */
+
+class AutonomyInterface
+{
+	public:
+		AutonomyInterface(Safety *safe);
+		~AutonomyInterface();
+		void update();
+		void reset();
+		bool getDriveCommand(float &forwardSpeed, float &turnSpeed);
+		bool getJointCommand(float jointPosition[NUM_MANIPULATOR_JOINTS]);
+		void setDriveState(const uint32_t encoder[NUM_DRIVE_MOTORS], const int motorSpeed[NUM_DRIVE_MOTORS], float distanceTravelled, bool following);
+		void setManipulatorState(const float jointPosition[NUM_MANIPULATOR_JOINTS], bool following);
+
+	private:
+		// Longest lease the robot will honour, in microseconds, regardless of what the command asks for
+		const uint32_t maxLeaseMicros = 500 * 1000;
+
+		AutonomyShared *shared;
+		AutonomyCommandData command;
+		AutonomyStateData state;
+		bool commandValid;
+		bool stateStaged;
+
+		Safety *safety;
+};
+
+#endif /* SRC_AUTONOMYINTERFACE_H_ */
@@ -0,0 +1,122 @@
+#ifndef SRC_AUTONOMYSHARED_H_
+#define SRC_AUTONOMYSHARED_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+
+/*
+ * Shared memory layout between the robot program and an on-board autonomy process.
+ * Kept free of WPILib so that the autonomy process can include it directly.
+ *
+ * The autonomy process maps autonomySharedName with shm_open/mmap (the robot program creates it),
+ * writes commands with seqlockWrite(shared->command) and reads state with seqlockRead(shared->state).
+ * Commands carry a CLOCK_MONOTONIC timestamp and a lease; the robot ignores them once the lease
+ * expires, and the operator joystick always takes precedence over them. They are only followed while
+ * the operator holds the Run button of the subsystem. A command with any non-finite field is ignored
+ * as a whole, and joint destinations are limited to the joint ranges.
+ */
+
+const char autonomySharedName[] = "/overkill_autonomy";
+const uint32_t autonomyMagic = 0x4F564B41; // "AKVO"
+const uint32_t autonomyVersion = 1;
+
+const unsigned AUTONOMY_DRIVE_MOTORS = 6;
+const unsigned AUTONOMY_MANIPULATOR_JOINTS = 5;
+
+// Bits in AutonomyCommandData::flags
+enum AutonomyCommandFlags
+{
+	AutonomyDriveCommand = 1 << 0, // forwardSpeed and turnSpeed are valid
+	AutonomyJointCommand = 1 << 1 // jointPosition is valid
+};
+
+struct AutonomyCommandData
+{
+	uint32_t flags;
+	uint32_t leaseMicros; // Command is ignored this long after timestampMicros
+	uint64_t timestampMicros; // monotonicMicros() when the command was written
+	float forwardSpeed; // Same range and sense as the DriveForward joystick axis
+	float turnSpeed; // Same range and sense as the DriveTurn joystick axis
+	float jointPosition[AUTONOMY_MANIPULATOR_JOINTS]; // Joint destinations in degrees
+};
+
+struct AutonomyStateData
+{
+	uint64_t timestampMicros; // monotonicMicros() when the state was published
+	int32_t encoder[AUTONOMY_DRIVE_MOTORS]; // Raw encoder counts
+	float motorSpeed[AUTONOMY_DRIVE_MOTORS]; // Encoder counts per drive period
+	float distanceTravelled; // Centimeters
+	float jointPosition[AUTONOMY_MANIPULATOR_JOINTS]; // Degrees
+	float driveCurrent[AUTONOMY_DRIVE_MOTORS]; // Amps
+	float manipulatorCurrent[AUTONOMY_MANIPULATOR_JOINTS]; // Amps
+	uint32_t relayEnabled;
+	uint32_t activeCommands; // AutonomyCommandFlags currently being followed (not overridden by the operator)
+};
+
+// Single-writer block guarded by a sequence counter that is odd while a write is in progress
+template <typename T>
+struct AutonomySeqlock
+{
+	std::atomic<uint32_t> sequence;
+	T data;
+};
+
+struct AutonomyShared
+{
+	uint32_t magic;
+	uint32_t version;
+	alignas(64) AutonomySeqlock<AutonomyCommandData> command; // Written by the autonomy process
+	alignas(64) AutonomySeqlock<AutonomyStateData> state; // Written by the robot program
+};
+
+/**
+ * Gets CLOCK_MONOTONIC time in microseconds, comparable between processes.
+ * @return monotonic time in microseconds
+ */
+inline uint64_t monotonicMicros()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * Publishes data to a seqlock block. Only one process may write to a given block.
+ * @param block block to write to
+ * @param data data to publish
+ */
+template <typename T>
+inline void seqlockWrite(AutonomySeqlock<T> &block, const T &data)
+{
+	uint32_t sequence = block.sequence.load(std::memory_order_relaxed);
+	block.sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&block.data, &data, sizeof(T));
+	block.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * Reads data from a seqlock block without blocking the writer.
+ * @param block block to read from
+ * @param data output copy of the data
+ * @param attempts number of times to retry if a write is in progress
+ * @return true if a consistent copy was read
+ */
+template <typename T>
+inline bool seqlockRead(const AutonomySeqlock<T> &block, T &data, unsigned attempts = 4)
+{
+	for(unsigned i = 0; i < attempts; ++i)
+	{
+		uint32_t sequence = block.sequence.load(std::memory_order_acquire);
+		if(sequence & 1) continue;
+		memcpy(&data, &block.data, sizeof(T));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(block.sequence.load(std::memory_order_relaxed) == sequence) return true;
+	}
+	return false;
+}
+
+#endif /* SRC_AUTONOMYSHARED_H_ */
@@ -0,0 +1,196 @@
+#include <BlackBox.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+static_assert(BLACKBOX_DRIVE_MOTORS == NUM_DRIVE_MOTORS, "BlackBoxFormat.h drive motor count out of date");
+static_assert(BLACKBOX_MANIPULATOR_JOINTS == NUM_MANIPULATOR_JOINTS, "BlackBoxFormat.h manipulator joint count out of date");
+static_assert(BLACKBOX_CARTESIAN_AXES == NUM_CARTESIAN_AXES, "BlackBoxFormat.h Cartesian axis count out of date");
+
+BlackBox *BlackBox::crashInstance = nullptr;
+
+// File name reason tags, indexed by BlackBoxReason
+static const char *reasonNames[] = {"relay", "mode"};
+
+BlackBox::BlackBox(const char *directory) : dumpDirectory(directory), frames(frameCapacity), snapshot(frameCapacity)
+{
+	nextFrame = 0;
+	frameCount = 0;
+	crashed = false;
+	snapshotCount = 0;
+	snapshotReason = 0;
+	snapshotTimestamp = 0;
+	writerBusy = false;
+	relayPending = false;
+	relayTimestamp = 0;
+	writerPending = false;
+	writerStopping = false;
+	snprintf(crashPath, sizeof(crashPath), "%s/blackbox_crash.bin", dumpDirectory.c_str());
+	findDumps();
+
+	writer = std::thread(&BlackBox::writerLoop, this);
+
+	// Dump the ring if the program dies on a fatal signal
+	crashInstance = this;
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = crashHandler;
+	action.sa_flags = SA_RESETHAND;
+	sigemptyset(&action.sa_mask);
+	const int crashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+	for(int crashSignal : crashSignals)
+		sigaction(crashSignal, &action, nullptr);
+}
+
+BlackBox::~BlackBox()
+{
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		writerStopping = true;
+	}
+	writerSignal.notify_one();
+	writer.join();
+	if(crashInstance == this) crashInstance = nullptr;
+}
+
+void BlackBox::record(BlackBoxSource source, const void *state, size_t size)
+{
+	if(crashed.load(std::memory_order_acquire)) return;
+
+	BlackBoxFrame &frame = frames[nextFrame];
+	frame.timestamp = getTimestampMicros();
+	frame.source = source;
+	memcpy(&frame.safety, state, size);
+
+	nextFrame = (nextFrame + 1) % frameCapacity;
+	if(frameCount < frameCapacity) ++frameCount;
+
+	// Take a queued relay trip as soon as the writer is free; the ring still holds the history before the trip
+	if(relayPending && !writerBusy.load(std::memory_order_acquire))
+	{
+		relayPending = false;
+		takeSnapshot(RelayTripReason, relayTimestamp);
+	}
+}
+
+void BlackBox::trigger(BlackBoxReason reason)
+{
+	if(frameCount == 0) return;
+
+	if(writerBusy.load(std::memory_order_acquire))
+	{
+		// Relay trips take priority: queue one behind the dump being written, others are dropped
+		if(reason == RelayTripReason && !relayPending)
+		{
+			relayPending = true;
+			relayTimestamp = getTimestampMicros();
+		}
+		return;
+	}
+	takeSnapshot(reason, getTimestampMicros());
+}
+
+void BlackBox::takeSnapshot(uint32_t reason, uint32_t timestamp)
+{
+	// Oldest frame is at nextFrame once the ring has wrapped, otherwise at the start
+	unsigned first = (frameCount < frameCapacity) ? 0 : nextFrame;
+	unsigned firstLength = std::min(frameCount, frameCapacity - first);
+	memcpy(&snapshot[0], &frames[first], firstLength * sizeof(BlackBoxFrame));
+	memcpy(&snapshot[firstLength], &frames[0], (frameCount - firstLength) * sizeof(BlackBoxFrame));
+	snapshotCount = frameCount;
+	snapshotReason = reason;
+	snapshotTimestamp = timestamp;
+
+	writerBusy.store(true, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		writerPending = true;
+	}
+	writerSignal.notify_one();
+}
+
+void BlackBox::findDumps()
+{
+	// Continue numbering after the newest dump of each reason left by earlier runs
+	for(unsigned &sequence : dumpSequence)
+		sequence = 0;
+	DIR *directory = opendir(dumpDirectory.c_str());
+	if(directory == nullptr) return;
+	while(struct dirent *entry = readdir(directory))
+	{
+		char name[16];
+		unsigned sequence;
+		if(sscanf(entry->d_name, "blackbox_%15[a-z]_%u.bin", name, &sequence) != 2) continue;
+		for(unsigned reason = 0; reason <= ModeChangeReason; ++reason)
+			if(strcmp(name, reasonNames[reason]) == 0)
+				dumpSequence[reason] = std::max(dumpSequence[reason], sequence + 1);
+	}
+	closedir(directory);
+}
+
+void BlackBox::writerLoop()
+{
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(writerMutex);
+			writerSignal.wait(lock, [this] { return writerPending || writerStopping; });
+			// A snapshot already taken is still written when stopping
+			if(!writerPending) return;
+			writerPending = false;
+		}
+
+		unsigned reason = std::min(snapshotReason, (uint32_t)ModeChangeReason);
+		unsigned sequence = dumpSequence[reason]++;
+		char path[128];
+		snprintf(path, sizeof(path), "%s/blackbox_%s_%u.bin", dumpDirectory.c_str(), reasonNames[reason], sequence);
+		if(!writeDump(path, &snapshot[0], 0, snapshotCount, snapshotReason, snapshotTimestamp))
+			std::cout << "BlackBox: failed to write " << path << std::endl;
+		else if(sequence >= dumpSlots)
+		{
+			snprintf(path, sizeof(path), "%s/blackbox_%s_%u.bin", dumpDirectory.c_str(), reasonNames[reason], sequence - dumpSlots);
+			unlink(path);
+		}
+
+		writerBusy.store(false, std::memory_order_release);
+	}
+}
+
+bool BlackBox::writeDump(const char *path, const BlackBoxFrame *buffer, unsigned first, unsigned count, uint32_t reason, uint32_t timestamp)
+{
+	// Only async-signal-safe calls here, as this also runs from crashHandler
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) return false;
+
+	BlackBoxHeader header;
+	header.magic = blackBoxMagic;
+	header.version = blackBoxVersion;
+	header.frameSize = sizeof(BlackBoxFrame);
+	header.frameCount = count;
+	header.reason = reason;
+	header.triggerTimestamp = timestamp;
+
+	// Frames from first to the end of the buffer, then wrapped around to the start
+	unsigned firstLength = std::min(count, frameCapacity - first);
+	bool ok = write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header);
+	ok = ok && write(fd, &buffer[first], firstLength * sizeof(BlackBoxFrame)) == (ssize_t)(firstLength * sizeof(BlackBoxFrame));
+	ok = ok && write(fd, &buffer[0], (count - firstLength) * sizeof(BlackBoxFrame)) == (ssize_t)((count - firstLength) * sizeof(BlackBoxFrame));
+	close(fd);
+	return ok;
+}
+
+void BlackBox::crashHandler(int signal)
+{
+	BlackBox *blackBox = crashInstance;
+	if(blackBox != nullptr && !blackBox->crashed.exchange(true))
+	{
+		unsigned first = (blackBox->frameCount < blackBox->frameCapacity) ? 0 : blackBox->nextFrame;
+		blackBox->writeDump(blackBox->crashPath, &blackBox->frames[0], first, blackBox->frameCount, CrashSignalReason, 0);
+	}
+
+	// SA_RESETHAND restored the default action, so re-raising terminates as usual
+	raise(signal);
+}
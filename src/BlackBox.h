@@ -0,0 +1,89 @@
+#ifndef SRC_BLACKBOX_H_
+#define SRC_BLACKBOX_H_
+
+#include <Constants.h>
+#include <BlackBoxFormat.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Post-mortem recorder.
+ * Safety, Drive and Manipulator copy their full state into a preallocated ring of frames every cycle.
+ * When trigger() is called (relay trip, mode change) the ring is copied into a second preallocated buffer
+ * and written to a dump file by a background thread, so recording never stops. On a fatal signal the ring
+ * is written synchronously from the signal handler before the program exits.
+ * Dump files are named by reason and a sequence number that continues across restarts (found from the
+ * existing files), and only the newest dumpSlots files per reason are kept, so mode changes never displace
+ * relay trip dumps. A relay trip that arrives while another dump is being written is snapshotted from the
+ * live ring and written as soon as that dump completes.
+ */
+
+class BlackBox
+{
+	public:
+		BlackBox(const char *directory = robotDataDirectory);
+		~BlackBox();
+		void record(const BlackBoxSafety &state) { record(SafetySource, &state, sizeof(state)); }
+		void record(const BlackBoxDrive &state) { record(DriveSource, &state, sizeof(state)); }
+		void record(const BlackBoxManipulator &state) { record(ManipulatorSource, &state, sizeof(state)); }
+		void trigger(BlackBoxReason reason);
+
+	private:
+		// Seconds of history kept in the ring
+		const unsigned recordSeconds = 10;
+
+		// Number of frames kept in the ring (all three loops record one frame per cycle)
+		const unsigned frameCapacity = recordSeconds * (1000000 / safetyPeriod + 1000000 / drivePeriod + 1000000 / manipulatorPeriod);
+
+		// Directory that dump files are written to
+		std::string dumpDirectory;
+
+		// Number of dump files kept per trigger reason; the oldest is deleted when a new one is written
+		const unsigned dumpSlots = 8;
+
+		std::vector<BlackBoxFrame> frames;
+		unsigned nextFrame;
+		unsigned frameCount;
+
+		// Set by the crash handler; frames recorded afterwards are dropped
+		std::atomic<bool> crashed;
+
+		// Copy of the ring being written by the writer thread, oldest frame first
+		std::vector<BlackBoxFrame> snapshot;
+		unsigned snapshotCount;
+		uint32_t snapshotReason;
+		uint32_t snapshotTimestamp;
+
+		// Set from taking a snapshot until the writer has written it
+		std::atomic<bool> writerBusy;
+
+		// Sequence number of the next dump file for each reason
+		unsigned dumpSequence[ModeChangeReason + 1];
+
+		// Relay trip received while another dump was being written, and when
+		bool relayPending;
+		uint32_t relayTimestamp;
+
+		char crashPath[128];
+
+		std::thread writer;
+		std::mutex writerMutex;
+		std::condition_variable writerSignal;
+		bool writerPending;
+		bool writerStopping;
+
+		void record(BlackBoxSource source, const void *state, size_t size);
+		void takeSnapshot(uint32_t reason, uint32_t timestamp);
+		void findDumps();
+		void writerLoop();
+		bool writeDump(const char *path, const BlackBoxFrame *buffer, unsigned first, unsigned count, uint32_t reason, uint32_t timestamp);
+
+		static BlackBox *crashInstance;
+		static void crashHandler(int signal);
+};
+
+#endif /* SRC_BLACKBOX_H_ */
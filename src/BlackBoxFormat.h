@@ -0,0 +1,104 @@
+#ifndef SRC_BLACKBOXFORMAT_H_
+#define SRC_BLACKBOXFORMAT_H_
+
+#include <stdint.h>
+
+/*
+ * Binary layout of black box dump files.
+ * Kept free of WPILib so that host tools can read dumps (see tools/BlackBoxToCsv.cpp).
+ * A dump is a BlackBoxHeader followed by frameCount BlackBoxFrames, oldest first.
+ * Array sizes must match NUM_DRIVE_MOTORS and NUM_MANIPULATOR_JOINTS (checked in BlackBox.cpp).
+ */
+
+const uint32_t blackBoxMagic = 0x58424B42; // "BKBX"
+const uint32_t blackBoxVersion = 1;
+
+const unsigned BLACKBOX_DRIVE_MOTORS = 6;
+const unsigned BLACKBOX_MANIPULATOR_JOINTS = 5;
+const unsigned BLACKBOX_CARTESIAN_AXES = 4;
+const unsigned BLACKBOX_JOYSTICK_AXES = 6;
+
+// Subsystem that recorded a frame
+enum BlackBoxSource
+{
+	SafetySource = 0,
+	DriveSource,
+	ManipulatorSource
+};
+
+// Event that caused a dump to be written
+enum BlackBoxReason
+{
+	RelayTripReason = 0,
+	ModeChangeReason,
+	CrashSignalReason
+};
+
+struct BlackBoxSafety
+{
+	float maxCurrentDrive;
+	float maxCurrentManipulator;
+	float driveCurrent[BLACKBOX_DRIVE_MOTORS];
+	float driveSafetyCurrent[BLACKBOX_DRIVE_MOTORS];
+	float driveControlCurrent[BLACKBOX_DRIVE_MOTORS];
+	float manipulatorCurrent[BLACKBOX_MANIPULATOR_JOINTS];
+	float manipulatorSafetyCurrent[BLACKBOX_MANIPULATOR_JOINTS];
+	float manipulatorControlCurrent[BLACKBOX_MANIPULATOR_JOINTS];
+	uint32_t relayEnabled;
+};
+
+struct BlackBoxDrive
+{
+	float axes[BLACKBOX_JOYSTICK_AXES];
+	uint32_t buttons; // Bit n set if joystick button n is held
+	float maxCurrent;
+	float leftSpeed;
+	float rightSpeed;
+	float adjLeftSpeed;
+	float adjRightSpeed;
+	int32_t encoder[BLACKBOX_DRIVE_MOTORS];
+	int32_t motorSpeed[BLACKBOX_DRIVE_MOTORS];
+	float lastPower[BLACKBOX_DRIVE_MOTORS];
+	float capPower[BLACKBOX_DRIVE_MOTORS];
+	float distanceTravelled;
+};
+
+struct BlackBoxManipulator
+{
+	float axes[BLACKBOX_JOYSTICK_AXES];
+	uint32_t buttons; // Bit n set if joystick button n is held
+	float maxCurrent;
+	float destPosition[BLACKBOX_MANIPULATOR_JOINTS];
+	float trackPosition[BLACKBOX_MANIPULATOR_JOINTS];
+	float jointPosition[BLACKBOX_MANIPULATOR_JOINTS];
+	float jointNoise[BLACKBOX_MANIPULATOR_JOINTS];
+	float lastSpeed[BLACKBOX_MANIPULATOR_JOINTS];
+	float lastPower[BLACKBOX_MANIPULATOR_JOINTS];
+	float lastError[BLACKBOX_MANIPULATOR_JOINTS];
+	float capPower[BLACKBOX_MANIPULATOR_JOINTS];
+	float cartesianTarget[BLACKBOX_CARTESIAN_AXES];
+};
+
+struct BlackBoxFrame
+{
+	uint32_t timestamp; // FPGA timestamp in microseconds
+	uint32_t source; // BlackBoxSource
+	union
+	{
+		BlackBoxSafety safety;
+		BlackBoxDrive drive;
+		BlackBoxManipulator manipulator;
+	};
+};
+
+struct BlackBoxHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t frameSize; // sizeof(BlackBoxFrame)
+	uint32_t frameCount;
+	uint32_t reason; // BlackBoxReason
+	uint32_t triggerTimestamp; // FPGA timestamp in microseconds
+};
+
+#endif /* SRC_BLACKBOXFORMAT_H_ */
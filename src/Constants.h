@@ -2,6 +2,7 @@
 #define SRC_CONSTANTS_H_
 
 #include <math.h>
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -16,6 +17,18 @@ const uint32_t drivePeriod = 50 * 1000;
 // Manipulator loop run period in microseconds (unit is microseconds per cycle)
 const uint32_t manipulatorPeriod = 25 * 1000;
 
+// Time in microseconds the operator must leave the controls neutral (with the Run button held) before the
+// autonomy process takes over a subsystem; any operator input hands control back and restarts the wait
+const uint32_t autonomyHandoverPeriod = 1000 * 1000;
+
+// Run the control loops with real-time scheduling, pinned to one core and with memory locked
+// Requires permission to use SCHED_FIFO and mlockall; falls back to normal scheduling without it
+// (see tools/soak/RealTimeJitter.cpp for the effect on loop jitter under CPU load)
+const bool realTimeMode = false;
+
+// Directory that calibration and log files are written to on the roboRIO
+const char robotDataDirectory[] = "/home/lvuser";
+
 // Relay DIO pin number: high keeps relay on, low turns it off
 const uint8_t relayPin = 25;
 
@@ -45,7 +58,9 @@ enum JoystickButtons
 	// On manipulator joystick (id: 1)
 	ManipulatorEnable = 1,
 	ManipulatorRun = 2,
-	ManipulatorControllable = 3
+	ManipulatorControllable = 3,
+	ManipulatorCartesian = 4, // Ignored unless manipulatorCartesianEnabled
+	ManipulatorCalibrate = 5
 };
 
 // Assign IDs to Drive Motors for use with other const arrays defined below
@@ -164,13 +179,37 @@ const float manipulatorJointLimits[NUM_MANIPULATOR_JOINTS][2] =
 	{-60, 50}
 };
 
+// Assign IDs to Manipulator Cartesian axes (gripper pose) in the same order as the joints they mostly move
+enum ManipulatorCartesianAxes
+{
+	CartesianHeight = 0, // Gripper height above elevator zero in centimeters
+	CartesianReach, // Gripper reach forward of slider zero in centimeters
+	CartesianPitch, // Gripper pitch angle in degrees
+	CartesianRoll, // Gripper roll angle in degrees
+	NUM_CARTESIAN_AXES
+};
+
+// Manipulator geometry used by Cartesian control.
+// PLACEHOLDERS: these have not been measured on the robot. Leave manipulatorCartesianEnabled off until they are,
+// as commands computed from them do not correspond to real gripper motion.
+const bool manipulatorCartesianEnabled = false;
+
+// Elevator height in centimeters per degree of elevator joint reading
+const float manipulatorElevatorScale = 1.0;
+
+// Slider travel in centimeters per degree of slider joint reading
+const float manipulatorSliderScale = 1.0;
+
+// Distance in centimeters from the pitch axis to the gripper
+const float manipulatorWristLength = 20.0;
+
 /**
  * Gets FPGA Timestamp in microseconds. Rolls over in 71 minutes.
  * @return FPGA Timestamp in microseconds
  */
 inline uint32_t getTimestampMicros()
 {
-	return (uint32_t) (Timer::GetFPGATimestamp() * 1000000);
+	return (uint32_t) (uint64_t) (Timer::GetFPGATimestamp() * 1000000); // Through 64 bits so the rollover wraps instead of saturating
 }
 
 /**
@@ -216,4 +255,23 @@ inline std::string numToString(float x)
 	return sign + (char)((int)(n/10)+'0') + (char)((int)(n%10)+'0');
 }
 
+/**
+ * Converts a count to a fixed-width zero-padded string for telemetry, clipping at the largest value that fits.
+ * @param x count to convert
+ * @param width number of digits
+ * @return string of width digits
+ */
+inline std::string countToString(uint32_t x, unsigned width = 5)
+{
+	uint32_t limit = 1;
+	for(unsigned i = 0; i < width; ++i)
+		limit *= 10;
+	x = std::min(x, limit - 1);
+
+	std::string digits(width, '0');
+	for(unsigned i = width; i > 0; --i, x /= 10)
+		digits[i-1] = (char)('0' + x % 10);
+	return digits;
+}
+
 #endif /* SRC_CONSTANTS_H_ */
@@ -1,22 +1,24 @@
 #include <Drive.h>
 
-Drive::Drive(Joystick *controller, Safety *safe)
+Drive::Drive(Joystick *controller, Safety *safe, MotorOutput *motors, BlackBox *recorder, AutonomyInterface *external)
 {
 	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
 	{
-		motorControllers[i] = std::make_shared<Victor>(driveMotorPins[i]);
 		encoders[i] = std::make_shared<Encoder>(driveEncoderPins[i][0], driveEncoderPins[i][1]);
 	}
 
 	this->joystick = controller;
 	this->safety = safe;
+	this->output = motors;
+	this->blackBox = recorder;
+	this->autonomy = external;
 	reset();
 }
 
-void Drive::update()
+bool Drive::update()
 {
 	uint32_t timestampMicros = getTimestampMicros();
-	if(timestampMicros - lastRunTimestamp < drivePeriod) return;
+	if(timestampMicros - lastRunTimestamp < drivePeriod) return false;
 	lastRunTimestamp = timestampMicros;
 
 	// Get max current setting
@@ -36,10 +38,22 @@ void Drive::update()
 
 	// Calculate desired motor speeds from joystick input
 	// Rover will not drive (hold at zero speed) unless the DriveRun button on the joystick is held
+	// Once DriveRun has been held with the joystick centred for autonomyHandoverPeriod, the autonomy process may
+	// command the speeds instead; the operator can stop it by releasing DriveRun or override it by moving the
+	// joystick, and autonomy only resumes after the joystick has been centred for the full period again
 
 	float forwardSpeed = joystick->GetRawAxis(DriveForward);
 	float turnSpeed = joystick->GetRawAxis(DriveTurn);
-	if(!joystick->GetRawButton(DriveRun)) forwardSpeed = turnSpeed = 0;
+	bool autonomous = false;
+	if(!joystick->GetRawButton(DriveRun) || (fabs(forwardSpeed) >= autonomyDeadband) || (fabs(turnSpeed) >= autonomyDeadband))
+		centredCycles = 0;
+	else if(centredCycles < autonomyHandoverCycles)
+		++centredCycles;
+
+	if(!joystick->GetRawButton(DriveRun))
+		forwardSpeed = turnSpeed = 0;
+	else if(centredCycles >= autonomyHandoverCycles)
+		autonomous = autonomy->getDriveCommand(forwardSpeed, turnSpeed);
 
 	float leftSpeed = constrain(forwardSpeed + turnSpeed, -1, 1);
 	float rightSpeed = constrain(forwardSpeed - turnSpeed, -1, 1);
@@ -108,7 +122,7 @@ void Drive::update()
 
 			lastPower[i] += constrain(speedError * kIntegral, -powerChangeMax, powerChangeMax);
 			lastPower[i] = constrain(lastPower[i], -(capPower[i] + 0.1), (capPower[i] + 0.1)); // Allow extra to see if motor is saturating
-			motorControllers[i]->Set(constrain(lastPower[i], -capPower[i], capPower[i]));
+			output->setDrive(i, constrain(lastPower[i], -capPower[i], capPower[i]));
 
 		}
 	}
@@ -116,13 +130,35 @@ void Drive::update()
 	{
 		for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
 		{
-			motorControllers[i]->Set(0);
+			output->setDrive(i, 0);
 			lastEncoder[i] = encoders[i]->GetRaw();
 			lastPower[i] = 0;
 			capPower[i] = 0;
 		}
 	}
 
+	BlackBoxDrive state;
+	for(unsigned i = 0; i < BLACKBOX_JOYSTICK_AXES; ++i)
+		state.axes[i] = joystick->GetRawAxis(i);
+	state.buttons = 0;
+	for(unsigned i = DriveEnable; i <= DriveOverride; ++i)
+		state.buttons |= joystick->GetRawButton(i) ? (1 << i) : 0;
+	state.maxCurrent = maxCurrent;
+	state.leftSpeed = leftSpeed;
+	state.rightSpeed = rightSpeed;
+	state.adjLeftSpeed = adjLeftSpeed;
+	state.adjRightSpeed = adjRightSpeed;
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+	{
+		state.encoder[i] = lastEncoder[i];
+		state.motorSpeed[i] = motorSpeed[i];
+		state.lastPower[i] = lastPower[i];
+		state.capPower[i] = capPower[i];
+	}
+	state.distanceTravelled = distanceTravelled;
+	blackBox->record(state);
+	autonomy->setDriveState(lastEncoder, motorSpeed, distanceTravelled, autonomous && joystick->GetRawButton(DriveEnable));
+
 	// Packet length = 3 * (10 + 6 * 4) + 6 = 108
 	std::string data = "DRIVE:";
 	data += numToString(joystick->GetRawButton(DriveEnable) ? 1 : 0);
@@ -148,17 +184,22 @@ void Drive::update()
 	data += std::to_string((int)distanceTravelled);
 	data += ":DRIVE";
 	std::cout << data << std::endl;
+	return true;
 }
 
 void Drive::reset()
 {
 	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
 	{
-		motorControllers[i]->Set(0);
+		output->setDrive(i, 0);
 		lastEncoder[i] = encoders[i]->GetRaw();
 		lastPower[i] = 0;
 		capPower[i] = 0;
 	}
 	lastRunTimestamp = getTimestampMicros() - drivePeriod;
 	distanceTravelled = 1;
+	centredCycles = 0;
+
+	int motorSpeed[NUM_DRIVE_MOTORS] = {0};
+	autonomy->setDriveState(lastEncoder, motorSpeed, distanceTravelled, false);
 }
@@ -3,6 +3,9 @@
 
 #include <Constants.h>
 #include <Safety.h>
+#include <MotorOutput.h>
+#include <BlackBox.h>
+#include <AutonomyInterface.h>
 
 /*
  * Encoder counts per revolution = 7
@@ -20,8 +23,8 @@
 class Drive
 {
 	public:
-		Drive(Joystick *controller, Safety *safe);
-		void update();
+		Drive(Joystick *controller, Safety *safe, MotorOutput *motors, BlackBox *recorder, AutonomyInterface *external);
+		bool update();
 		void reset();
 
 	private:
@@ -41,7 +44,12 @@ class Drive
 		const float maxCurrentUpper = 15;
 		const float maxCurrentLower = 10;
 
-		std::shared_ptr<Victor> motorControllers[NUM_DRIVE_MOTORS];
+		// Joystick axes must be within this of centre for the autonomy process to command the speeds
+		const float autonomyDeadband = 0.05;
+
+		// Number of consecutive cycles the joystick must stay centred before the autonomy process takes over
+		const unsigned autonomyHandoverCycles = autonomyHandoverPeriod / drivePeriod;
+
 		std::shared_ptr<Encoder> encoders[NUM_DRIVE_MOTORS];
 
 		uint32_t lastEncoder[NUM_DRIVE_MOTORS];
@@ -51,9 +59,15 @@ class Drive
 		// Average distance traveled by rover in centimeters
 		float distanceTravelled;
 
+		// Consecutive cycles with DriveRun held and the joystick centred, up to autonomyHandoverCycles
+		unsigned centredCycles;
+
 		uint32_t lastRunTimestamp;
 		Joystick *joystick;
 		Safety *safety;
+		MotorOutput *output;
+		BlackBox *blackBox;
+		AutonomyInterface *autonomy;
 };
 
 #endif /* SRC_DRIVE_H_ */
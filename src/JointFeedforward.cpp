@@ -0,0 +1,141 @@
+#include <JointFeedforward.h>
+
+#include <fstream>
+
+JointFeedforward::JointFeedforward(const char *directory)
+{
+	parameterFile = std::string(directory) + "/feedforward.txt";
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		kGravity[i] = 0;
+		kStatic[i] = 0;
+		kViscous[i] = 0;
+	}
+	load();
+	reset();
+}
+
+float JointFeedforward::get(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed)
+{
+	if(ch >= NUM_MANIPULATOR_JOINTS) return 0;
+	double terms[3];
+	basis(ch, jointPosition, speed, terms);
+	return kGravity[ch] * terms[0] + kStatic[ch] * terms[1] + kViscous[ch] * terms[2];
+}
+
+void JointFeedforward::calibrate(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed, float power)
+{
+	if(ch >= NUM_MANIPULATOR_JOINTS) return;
+	double terms[3];
+	basis(ch, jointPosition, speed, terms);
+	for(unsigned row = 0; row < 3; ++row)
+	{
+		for(unsigned col = 0; col < 3; ++col)
+			normalMatrix[ch][row][col] += terms[row] * terms[col];
+		normalVector[ch][row] += terms[row] * power;
+	}
+	++samples[ch];
+}
+
+bool JointFeedforward::identify()
+{
+	bool identified = false;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		if(samples[i] < minSamples) continue;
+
+		// Solve (A + ridge * I) x = b by Gaussian elimination with partial pivoting
+		double a[3][4];
+		for(unsigned row = 0; row < 3; ++row)
+		{
+			for(unsigned col = 0; col < 3; ++col)
+				a[row][col] = normalMatrix[i][row][col] + ((row == col) ? regularisation * samples[i] : 0);
+			a[row][3] = normalVector[i][row];
+		}
+		for(unsigned col = 0; col < 3; ++col)
+		{
+			unsigned pivot = col;
+			for(unsigned row = col + 1; row < 3; ++row)
+				if(fabs(a[row][col]) > fabs(a[pivot][col])) pivot = row;
+			for(unsigned k = 0; k < 4; ++k)
+				std::swap(a[col][k], a[pivot][k]);
+			for(unsigned row = col + 1; row < 3; ++row)
+			{
+				double factor = a[row][col] / a[col][col];
+				for(unsigned k = col; k < 4; ++k)
+					a[row][k] -= factor * a[col][k];
+			}
+		}
+		double x[3];
+		for(int row = 2; row >= 0; --row)
+		{
+			x[row] = a[row][3];
+			for(unsigned k = row + 1; k < 3; ++k)
+				x[row] -= a[row][k] * x[k];
+			x[row] /= a[row][row];
+		}
+
+		kGravity[i] = constrain(x[0], -maxCoefficient, maxCoefficient);
+		kStatic[i] = constrain(x[1], 0, maxCoefficient); // Friction always opposes motion
+		kViscous[i] = constrain(x[2], 0, maxCoefficient);
+		identified = true;
+	}
+
+	if(identified) save();
+	reset();
+	return identified;
+}
+
+void JointFeedforward::reset()
+{
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		for(unsigned row = 0; row < 3; ++row)
+		{
+			for(unsigned col = 0; col < 3; ++col)
+				normalMatrix[i][row][col] = 0;
+			normalVector[i][row] = 0;
+		}
+		samples[i] = 0;
+	}
+}
+
+void JointFeedforward::basis(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed, double terms[3])
+{
+	// Gravity torque: the elevator lifts a constant load, the pitch joint carries the wrist at angle pitch from horizontal
+	if(ch == ElevatorJoint)
+		terms[0] = 1;
+	else if(ch == PitchJoint)
+		terms[0] = std::cos(jointPosition[PitchJoint] * (float)M_PI / 180);
+	else
+		terms[0] = 0;
+
+	terms[1] = (speed > staticSpeedThreshold) ? 1 : ((speed < -staticSpeedThreshold) ? -1 : 0);
+	terms[2] = speed;
+}
+
+void JointFeedforward::load()
+{
+	std::ifstream file(parameterFile);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS && file; ++i)
+	{
+		float gravity, staticFriction, viscousFriction;
+		if(file >> gravity >> staticFriction >> viscousFriction)
+		{
+			kGravity[i] = constrain(gravity, -maxCoefficient, maxCoefficient);
+			kStatic[i] = constrain(staticFriction, 0, maxCoefficient);
+			kViscous[i] = constrain(viscousFriction, 0, maxCoefficient);
+		}
+	}
+}
+
+void JointFeedforward::save()
+{
+	std::ofstream file(parameterFile);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		file << kGravity[i] << " " << kStatic[i] << " " << kViscous[i] << std::endl;
+	if(!file)
+		std::cout << "JointFeedforward: could not save " << parameterFile << std::endl;
+	else
+		std::cout << "JointFeedforward: saved " << parameterFile << std::endl;
+}
@@ -0,0 +1,55 @@
+#ifndef SRC_JOINTFEEDFORWARD_H_
+#define SRC_JOINTFEEDFORWARD_H_
+
+#include <Constants.h>
+
+/*
+ * Gravity and friction feedforward for the manipulator joints.
+ * power = kGravity * gravity(pose) + kStatic * sign(speed) + kViscous * speed
+ * where gravity(pose) is 1 for the elevator, cos(pitch) for the pitch joint and 0 for the others.
+ *
+ * The coefficients are identified by least squares from a calibration sweep: while calibrating, each
+ * cycle's pose, commanded speed and applied power are accumulated, and identify() fits the coefficients
+ * and saves them to parameterFile, from which they are loaded at startup.
+ */
+
+class JointFeedforward
+{
+	public:
+		JointFeedforward(const char *directory = robotDataDirectory);
+		float get(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed);
+		void calibrate(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed, float power);
+		bool identify();
+		void reset();
+
+	private:
+		// File the identified coefficients are saved to and loaded from (one line of kGravity kStatic kViscous per joint)
+		std::string parameterFile;
+
+		// Speeds below this (in degrees per second) are treated as stationary for static friction
+		const float staticSpeedThreshold = 0.5;
+
+		// Minimum calibration samples per joint before its coefficients are identified
+		const unsigned minSamples = 200;
+
+		// Ridge regularisation per sample, keeps coefficients of unexcited terms near zero
+		const double regularisation = 1e-3;
+
+		// Largest magnitude allowed for any identified coefficient term
+		const float maxCoefficient = 1.0;
+
+		float kGravity[NUM_MANIPULATOR_JOINTS];
+		float kStatic[NUM_MANIPULATOR_JOINTS];
+		float kViscous[NUM_MANIPULATOR_JOINTS];
+
+		// Least squares normal equations accumulated during calibration
+		double normalMatrix[NUM_MANIPULATOR_JOINTS][3][3];
+		double normalVector[NUM_MANIPULATOR_JOINTS][3];
+		unsigned samples[NUM_MANIPULATOR_JOINTS];
+
+		void basis(unsigned ch, const float jointPosition[NUM_MANIPULATOR_JOINTS], float speed, double terms[3]);
+		void load();
+		void save();
+};
+
+#endif /* SRC_JOINTFEEDFORWARD_H_ */
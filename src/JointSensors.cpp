@@ -0,0 +1,66 @@
+#include <JointSensors.h>
+
+JointSensors::JointSensors()
+{
+	AnalogInput::SetSampleRate(sampleRate);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		analogInputs[i] = std::make_shared<AnalogInput>(manipulatorPotentiometerPins[i]);
+		analogInputs[i]->SetAverageBits(averageBits);
+		analogInputs[i]->SetOversampleBits(oversampleBits);
+
+		// Same conversion as AnalogPotentiometer(pin, scale, -scale * offset), computed once
+		scale[i] = manipulatorPotentiometerScale[i];
+		offset[i] = -manipulatorPotentiometerScale[i] * manipulatorPotentiometerOffset[i];
+		position[i] = 0;
+	}
+	reset();
+}
+
+void JointSensors::update()
+{
+	float supplyVoltage = ControllerPower::GetVoltage5V();
+	historyIndex = (historyIndex + 1) % 3;
+
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		float reading = read(i, supplyVoltage);
+		history[i][historyIndex] = reading;
+
+		// A jump that persists into the next cycle is real and is followed then
+		if(spikeFilter && !spikeHeld[i] && (fabs(reading - position[i]) > spikeThreshold))
+		{
+			reading = position[i];
+			spikeHeld[i] = true;
+		}
+		else
+			spikeHeld[i] = false;
+
+		// The second difference of the raw readings cancels motion at constant speed; for independent
+		// noise of variance v per reading its variance is (1 + 4 + 1) * v
+		float deviation = history[i][historyIndex] - 2 * history[i][(historyIndex + 2) % 3] + history[i][(historyIndex + 1) % 3];
+		noiseVariance[i] = ((1-noiseFilter) * noiseVariance[i]) + noiseFilter * deviation * deviation / 6;
+		position[i] = reading;
+	}
+}
+
+void JointSensors::reset()
+{
+	float supplyVoltage = ControllerPower::GetVoltage5V();
+	historyIndex = 0;
+
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		position[i] = read(i, supplyVoltage);
+		for(unsigned j = 0; j < 3; ++j)
+			history[i][j] = position[i];
+		noiseVariance[i] = 0;
+		spikeHeld[i] = false;
+	}
+}
+
+float JointSensors::read(unsigned ch, float supplyVoltage)
+{
+	if(supplyVoltage <= 0) return position[ch];
+	return ((float)analogInputs[ch]->GetAverageVoltage() / supplyVoltage) * scale[ch] + offset[ch];
+}
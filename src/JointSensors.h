@@ -0,0 +1,57 @@
+#ifndef SRC_JOINTSENSORS_H_
+#define SRC_JOINTSENSORS_H_
+
+#include <Constants.h>
+
+/*
+ * Acquisition of the manipulator joint potentiometers.
+ * The analog inputs are configured to oversample and average in the FPGA, so each read returns
+ * the mean of 2^(averageBits + oversampleBits) samples. All joints are read in one pass by update()
+ * and converted to degrees. Single-cycle spikes are optionally rejected; otherwise the newest reading is
+ * used as is, so the position feedback has no added lag.
+ * A running estimate of the noise on each joint (standard deviation in degrees) is also kept,
+ * taken from the second difference of the raw readings so that joint motion is not counted as noise.
+ */
+
+class JointSensors
+{
+	public:
+		JointSensors();
+		void update();
+		void reset();
+		float getPosition(unsigned ch) { return (ch < NUM_MANIPULATOR_JOINTS) ? position[ch] : 0; }
+		float getNoise(unsigned ch) { return (ch < NUM_MANIPULATOR_JOINTS) ? std::sqrt(noiseVariance[ch]) : 0; }
+
+	private:
+		// Number of samples averaged (2^bits) and oversampled (2^bits) by the FPGA for each reading
+		const int averageBits = 4;
+		const int oversampleBits = 2;
+
+		// Global analog input sample rate in samples per second (shared by all channels)
+		const double sampleRate = 50000;
+
+		// Hold the previous position for one cycle when a reading jumps by more than spikeThreshold degrees
+		// (joints move at most about 0.5 degrees per manipulator cycle)
+		const bool spikeFilter = true;
+		const float spikeThreshold = 5;
+
+		// Noise estimate LPF parameter; 1 = fastest response, 0 = no response
+		const float noiseFilter = 0.05;
+
+		std::shared_ptr<AnalogInput> analogInputs[NUM_MANIPULATOR_JOINTS];
+
+		// Conversion from input voltage ratio (0 to 1 of the 5V rail) to degrees
+		float scale[NUM_MANIPULATOR_JOINTS];
+		float offset[NUM_MANIPULATOR_JOINTS];
+
+		float history[NUM_MANIPULATOR_JOINTS][3];
+		unsigned historyIndex;
+		bool spikeHeld[NUM_MANIPULATOR_JOINTS];
+
+		float position[NUM_MANIPULATOR_JOINTS];
+		float noiseVariance[NUM_MANIPULATOR_JOINTS];
+
+		float read(unsigned ch, float supplyVoltage);
+};
+
+#endif /* SRC_JOINTSENSORS_H_ */
@@ -0,0 +1,43 @@
+#include <Kinematics.h>
+
+// Conversion from degrees to radians
+static const float degreesToRadians = M_PI / 180.0;
+
+void forwardKinematics(const float joints[NUM_MANIPULATOR_JOINTS], float pose[NUM_CARTESIAN_AXES])
+{
+	float pitch = joints[PitchJoint] * degreesToRadians;
+	pose[CartesianHeight] = joints[ElevatorJoint] * manipulatorElevatorScale + manipulatorWristLength * std::sin(pitch);
+	pose[CartesianReach] = joints[SliderJoint] * manipulatorSliderScale + manipulatorWristLength * std::cos(pitch);
+	pose[CartesianPitch] = joints[PitchJoint];
+	pose[CartesianRoll] = joints[RollJoint];
+}
+
+bool inverseKinematics(float pose[NUM_CARTESIAN_AXES], float joints[NUM_MANIPULATOR_JOINTS])
+{
+	// Pitch and roll are commanded directly, then the elevator and slider take up the remaining offset
+	// at the pitch the wrist can actually reach
+	bool reachable = true;
+	joints[PitchJoint] = pose[CartesianPitch];
+	joints[RollJoint] = pose[CartesianRoll];
+	for(unsigned i = PitchJoint; i <= RollJoint; ++i)
+	{
+		float limited = constrain(joints[i], manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
+		if(limited != joints[i]) reachable = false;
+		joints[i] = limited;
+	}
+
+	float pitch = joints[PitchJoint] * degreesToRadians;
+	joints[ElevatorJoint] = (pose[CartesianHeight] - manipulatorWristLength * std::sin(pitch)) / manipulatorElevatorScale;
+	joints[SliderJoint] = (pose[CartesianReach] - manipulatorWristLength * std::cos(pitch)) / manipulatorSliderScale;
+	for(unsigned i = ElevatorJoint; i <= SliderJoint; ++i)
+	{
+		float limited = constrain(joints[i], manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
+		if(limited != joints[i]) reachable = false;
+		joints[i] = limited;
+	}
+
+	// Pull the pose back to what the limited joints actually reach so the target does not wind up past the limits
+	if(!reachable)
+		forwardKinematics(joints, pose);
+	return reachable;
+}
@@ -0,0 +1,32 @@
+#ifndef SRC_KINEMATICS_H_
+#define SRC_KINEMATICS_H_
+
+#include <Constants.h>
+
+/*
+ * Closed-form kinematics of the elevator, slider, pitch and roll chain.
+ * The elevator moves the arm vertically and the slider moves it forward, so the gripper position is
+ * the elevator and slider offsets plus the wrist link rotated by the pitch joint. Roll maps directly.
+ * The gripper joint is not part of the chain and is left untouched.
+ *
+ * height = elevator * manipulatorElevatorScale + manipulatorWristLength * sin(pitch)
+ * reach = slider * manipulatorSliderScale + manipulatorWristLength * cos(pitch)
+ */
+
+/**
+ * Computes the gripper pose from joint positions.
+ * @param joints joint positions in degrees (indexed by ManipulatorJoints)
+ * @param pose output gripper pose (indexed by ManipulatorCartesianAxes)
+ */
+void forwardKinematics(const float joints[NUM_MANIPULATOR_JOINTS], float pose[NUM_CARTESIAN_AXES]);
+
+/**
+ * Computes joint positions for a gripper pose, constrained to the joint limits.
+ * If a joint limit is hit, the pose is updated to the reachable pose actually commanded.
+ * @param pose gripper pose (indexed by ManipulatorCartesianAxes), adjusted if not reachable
+ * @param joints output joint positions in degrees (indexed by ManipulatorJoints)
+ * @return true if the requested pose was reachable without hitting a joint limit
+ */
+bool inverseKinematics(float pose[NUM_CARTESIAN_AXES], float joints[NUM_MANIPULATOR_JOINTS]);
+
+#endif /* SRC_KINEMATICS_H_ */
@@ -1,23 +1,24 @@
 #include <Manipulator.h>
 
-Manipulator::Manipulator(Joystick *controller, Safety *safe)
+Manipulator::Manipulator(Joystick *controller, Safety *safe, MotorOutput *motors, BlackBox *recorder, AutonomyInterface *external,
+		const char *dataDirectory)
 {
-	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
-	{
-		motorControllers[i] = std::make_shared<Victor>(manipulatorMotorPins[i]);
-		potentiometers[i] = std::make_shared<AnalogPotentiometer>(manipulatorPotentiometerPins[i],
-				manipulatorPotentiometerScale[i], -manipulatorPotentiometerScale[i]*manipulatorPotentiometerOffset[i]);
-	}
+	jointSensors = std::make_shared<JointSensors>();
+	jointFeedforward = std::make_shared<JointFeedforward>(dataDirectory);
+	calibrating = false;
 
 	this->joystick = controller;
 	this->safety = safe;
+	this->output = motors;
+	this->blackBox = recorder;
+	this->autonomy = external;
 	reset();
 }
 
-void Manipulator::update()
+bool Manipulator::update()
 {
 	uint32_t timestampMicros = getTimestampMicros();
-	if(timestampMicros - lastRunTimestamp < manipulatorPeriod) return;
+	if(timestampMicros - lastRunTimestamp < manipulatorPeriod) return false;
 	lastRunTimestamp = timestampMicros;
 
 	// Get max current setting
@@ -35,19 +36,48 @@ void Manipulator::update()
 	}
 
 	// Get the target and current joint positions
-    // The desired joint positions are read only if ManipulatorControllable button on the joystick is held
+	// The desired joint positions are read only if ManipulatorControllable button on the joystick is held
+	// If the ManipulatorCartesian button is also held and manipulatorCartesianEnabled, the joystick axes move the gripper pose instead of the joints
+	// Otherwise, once ManipulatorRun has been held without ManipulatorControllable for autonomyHandoverPeriod, the
+	// autonomy process may set the desired joint positions; the operator can stop it by releasing ManipulatorRun or
+	// override it with ManipulatorControllable, which restarts the hand-over wait
 
 	float jointPosition[NUM_MANIPULATOR_JOINTS];
+	jointSensors->update();
+
+	bool cartesian = manipulatorCartesianEnabled && joystick->GetRawButton(ManipulatorControllable) && joystick->GetRawButton(ManipulatorCartesian);
+	if(!joystick->GetRawButton(ManipulatorRun) || joystick->GetRawButton(ManipulatorControllable))
+		releasedCycles = 0;
+	else if(releasedCycles < autonomyHandoverCycles)
+		++releasedCycles;
+	bool autonomous = (releasedCycles >= autonomyHandoverCycles) && autonomy->getJointCommand(destPosition);
+	if(cartesian)
+	{
+		for(unsigned i = 0; i < NUM_CARTESIAN_AXES; ++i)
+		{
+			float axis = joystick->GetRawAxis(ElevatorPosition+i);
+			if(fabs(axis) > cartesianDeadband)
+				cartesianTarget[i] += axis * maxCartesianSpeed[i];
+		}
+
+		uint32_t solveStart = getTimestampMicros();
+		inverseKinematics(cartesianTarget, destPosition);
+		ikSolveMicros = getTimestampMicros() - solveStart;
+	}
 
 	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 	{
-		if(joystick->GetRawButton(ManipulatorControllable))
+		if(joystick->GetRawButton(ManipulatorControllable) && (!cartesian || (i == GripperJoint)))
 			destPosition[i] = map(joystick->GetRawAxis(ElevatorPosition+i), -1, 1, manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
 
 		destPosition[i] = constrain(destPosition[i], manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
-		jointPosition[i] = potentiometers[i]->Get();
+		jointPosition[i] = jointSensors->getPosition(i);
 	}
 
+	// Keep the Cartesian target at the current destination so that switching into Cartesian mode does not jump
+	if(!cartesian)
+		forwardKinematics(destPosition, cartesianTarget);
+
 	// Calculate the trajectory from current position to the target position
 	// The trajectory updates only if ManipulatorRun button on the joystick is held
 
@@ -89,41 +119,82 @@ void Manipulator::update()
 			lastSpeed[i] = 0;
 	}
 
-	// Perform proportional-integral control to obtain desired motor position
+	// Perform proportional-derivative control with gravity and friction feedforward to obtain desired motor position
 	// Motor power is set to zero if the ManipulatorEnable button on the joystick is not held
+	// While the ManipulatorCalibrate button is held, the applied powers are collected to identify the feedforward,
+	// which happens when the button is released (sweep each joint slowly through its range while holding it)
 
 	if(joystick->GetRawButton(ManipulatorEnable))
 	{
-		float positionError = 0, powerChange = 0;
+		bool calibrate = joystick->GetRawButton(ManipulatorCalibrate);
+		float positionError = 0, powerChange = 0, speed = 0;
 		for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 		{
 			trackPosition[i] = constrain(trackPosition[i], manipulatorJointLimits[i][0], manipulatorJointLimits[i][1]);
 			positionError = trackPosition[i] - jointPosition[i];
+			speed = lastSpeed[i] * (1000000.0 / manipulatorPeriod); // Degrees per second
 
-			powerChange = positionError * kProportional[i] + (positionError - lastError[i]) * kDerivative[i] - lastPower[i];
+			powerChange = positionError * kProportional[i] + (positionError - lastError[i]) * kDerivative[i]
+					+ jointFeedforward->get(i, jointPosition, speed) - lastPower[i];
 			powerChange = constrain(powerChange, -powerChangeMax, powerChangeMax);
 
 			lastError[i] = positionError;
 			lastPower[i] += powerChange;
 			lastPower[i] = constrain(lastPower[i], -(capPower[i] + 0.1), (capPower[i] + 0.1)); // Allow extra to see if motor is saturating
-			motorControllers[i]->Set(constrain(lastPower[i], -capPower[i], capPower[i]));
+			output->setManipulator(i, constrain(lastPower[i], -capPower[i], capPower[i]));
+
+			// Saturated samples do not show the power the joint actually needs
+			if(calibrate && (fabs(lastPower[i]) < capPower[i]))
+				jointFeedforward->calibrate(i, jointPosition, speed, lastPower[i]);
 		}
+
+		if(calibrating && !calibrate)
+			jointFeedforward->identify();
+		calibrating = calibrate;
 	}
 	else
 	{
 		for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 		{
-			motorControllers[i]->Set(0);
-			trackPosition[i] = potentiometers[i]->Get();
-			destPosition[i] = potentiometers[i]->Get();
+			output->setManipulator(i, 0);
+			trackPosition[i] = jointPosition[i];
+			destPosition[i] = jointPosition[i];
 			lastSpeed[i] = 0;
 			lastPower[i] = 0;
 			lastError[i] = 0;
 			capPower[i] = 0;
 		}
+		forwardKinematics(destPosition, cartesianTarget);
+
+		// Abandon a calibration sweep if the manipulator is disabled part way through
+		if(calibrating) jointFeedforward->reset();
+		calibrating = false;
+	}
+
+	BlackBoxManipulator state;
+	for(unsigned i = 0; i < BLACKBOX_JOYSTICK_AXES; ++i)
+		state.axes[i] = joystick->GetRawAxis(i);
+	state.buttons = 0;
+	for(unsigned i = ManipulatorEnable; i <= ManipulatorCalibrate; ++i)
+		state.buttons |= joystick->GetRawButton(i) ? (1 << i) : 0;
+	state.maxCurrent = maxCurrent;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		state.destPosition[i] = destPosition[i];
+		state.trackPosition[i] = trackPosition[i];
+		state.jointPosition[i] = jointPosition[i];
+		state.jointNoise[i] = jointSensors->getNoise(i);
+		state.lastSpeed[i] = lastSpeed[i];
+		state.lastPower[i] = lastPower[i];
+		state.lastError[i] = lastError[i];
+		state.capPower[i] = capPower[i];
 	}
+	for(unsigned i = 0; i < NUM_CARTESIAN_AXES; ++i)
+		state.cartesianTarget[i] = cartesianTarget[i];
+	blackBox->record(state);
+	autonomy->setManipulatorState(jointPosition, autonomous && joystick->GetRawButton(ManipulatorEnable));
 
-	// Packet length = 3 * (4 + 5 * 7) = 117
+	// Packet length = 3 * (4 + 5 * 8 + 2) = 138
 	std::string data = "MANIP:";
 	data += numToString(joystick->GetRawButton(ManipulatorEnable) ? 1 : 0);
 	data += numToString(joystick->GetRawButton(ManipulatorRun) ? 1 : 0);
@@ -143,6 +214,10 @@ void Manipulator::update()
 		data += numToString(safety->getManipulatorCurrent(i)/100.0);
 	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 		data += numToString(capPower[i]);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		data += numToString(jointSensors->getNoise(i)/10.0);
+	data += numToString(cartesian ? 1 : 0);
+	data += numToString(ikSolveMicros/100.0);
 	data += ":MANIP";
 	std::cout << data << std::endl;
 
@@ -150,19 +225,27 @@ void Manipulator::update()
 	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 		std::cout << "Pot " << i << ": " << jointPosition[i] << std::endl;
 	*/
+	return true;
 }
 
 void Manipulator::reset()
 {
+	jointSensors->reset();
 	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
 	{
-		motorControllers[i]->Set(0);
-		trackPosition[i] = potentiometers[i]->Get();
-		destPosition[i] = potentiometers[i]->Get();
+		output->setManipulator(i, 0);
+		trackPosition[i] = jointSensors->getPosition(i);
+		destPosition[i] = jointSensors->getPosition(i);
 		lastSpeed[i] = 0;
 		lastPower[i] = 0;
 		lastError[i] = 0;
 		capPower[i] = 0;
 	}
+	forwardKinematics(destPosition, cartesianTarget);
+	ikSolveMicros = 0;
+	releasedCycles = 0;
+	jointFeedforward->reset();
+	calibrating = false;
+	autonomy->setManipulatorState(destPosition, false);
 	lastRunTimestamp = getTimestampMicros() - manipulatorPeriod;
 }
@@ -3,12 +3,19 @@
 
 #include <Constants.h>
 #include <Safety.h>
+#include <MotorOutput.h>
+#include <BlackBox.h>
+#include <AutonomyInterface.h>
+#include <JointSensors.h>
+#include <Kinematics.h>
+#include <JointFeedforward.h>
 
 class Manipulator
 {
 	public:
-		Manipulator(Joystick *controller, Safety *safe);
-		void update();
+		Manipulator(Joystick *controller, Safety *safe, MotorOutput *motors, BlackBox *recorder, AutonomyInterface *external,
+				const char *dataDirectory = robotDataDirectory);
+		bool update();
 		void reset();
 
 	protected:
@@ -20,6 +27,21 @@ class Manipulator
 		// Maximum joint angle acceleration (in degrees per second squared times manipulatorPeriod in seconds/cycle squared)
 		const float maxAccel = 30.0 * ((float)manipulatorPeriod / 1000000.0) * ((float)manipulatorPeriod / 1000000.0);
 
+		// Maximum gripper velocity in Cartesian mode (in centimeters or degrees per second times manipulatorPeriod in seconds/cycle)
+		const float maxCartesianSpeed[NUM_CARTESIAN_AXES] =
+		{
+			10.0 * ((float)manipulatorPeriod / 1000000.0),
+			10.0 * ((float)manipulatorPeriod / 1000000.0),
+			30.0 * ((float)manipulatorPeriod / 1000000.0),
+			30.0 * ((float)manipulatorPeriod / 1000000.0)
+		};
+
+		// Joystick deflection below which Cartesian velocity commands are ignored
+		const float cartesianDeadband = 0.05;
+
+		// Number of consecutive cycles ManipulatorControllable must stay released before the autonomy process takes over
+		const unsigned autonomyHandoverCycles = autonomyHandoverPeriod / manipulatorPeriod;
+
 		// Maximum power for each motor
 		const float maxPower[NUM_MANIPULATOR_JOINTS] =
 		{
@@ -57,12 +79,24 @@ class Manipulator
 		const float maxCurrentUpper = 15;
 		const float maxCurrentLower = 10;
 
-		std::shared_ptr<Victor> motorControllers[NUM_MANIPULATOR_JOINTS];
-		std::shared_ptr<AnalogPotentiometer> potentiometers[NUM_MANIPULATOR_JOINTS];
+		std::shared_ptr<JointSensors> jointSensors;
+		std::shared_ptr<JointFeedforward> jointFeedforward;
+
+		// Set while feedforward calibration samples are being collected
+		bool calibrating;
 
 		float destPosition[NUM_MANIPULATOR_JOINTS];
 		float trackPosition[NUM_MANIPULATOR_JOINTS];
 
+		// Gripper pose target used in Cartesian mode, kept in sync with destPosition otherwise
+		float cartesianTarget[NUM_CARTESIAN_AXES];
+
+		// Time taken by the last inverse kinematics solve in microseconds
+		uint32_t ikSolveMicros;
+
+		// Consecutive cycles with ManipulatorRun held and ManipulatorControllable released, up to autonomyHandoverCycles
+		unsigned releasedCycles;
+
 		float lastSpeed[NUM_MANIPULATOR_JOINTS];
 		float lastPower[NUM_MANIPULATOR_JOINTS];
 		float lastError[NUM_MANIPULATOR_JOINTS];
@@ -71,6 +105,9 @@ class Manipulator
 		uint32_t lastRunTimestamp;
 		Joystick *joystick;
 		Safety *safety;
+		MotorOutput *output;
+		BlackBox *blackBox;
+		AutonomyInterface *autonomy;
 };
 
 #endif /* SRC_MANIPULATOR_H_ */
@@ -0,0 +1,72 @@
+#include <MotorOutput.h>
+
+MotorOutput::MotorOutput()
+{
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+		motorControllers[i] = std::make_shared<Victor>(driveMotorPins[i]);
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		motorControllers[NUM_DRIVE_MOTORS + i] = std::make_shared<Victor>(manipulatorMotorPins[i]);
+
+	writesIssued = 0;
+	writesSuppressed = 0;
+	reportedIssued = 0;
+	reportedSuppressed = 0;
+	reset();
+}
+
+void MotorOutput::update()
+{
+	uint32_t timestampMicros = getTimestampMicros();
+	if(timestampMicros - lastReportTimestamp >= reportPeriod)
+	{
+		lastReportTimestamp = timestampMicros;
+
+		// Packet length = 2 * 5 = 10
+		std::string data = "OUTPUT:";
+		data += countToString(writesIssued - reportedIssued);
+		data += countToString(writesSuppressed - reportedSuppressed);
+		data += ":OUTPUT";
+		std::cout << data << std::endl;
+		reportedIssued = writesIssued;
+		reportedSuppressed = writesSuppressed;
+	}
+
+	if(!staged && (timestampMicros - lastCommitTimestamp < outputRefreshPeriod)) return;
+	staged = false;
+	lastCommitTimestamp = timestampMicros;
+
+	for(unsigned i = 0; i < NUM_MOTOR_OUTPUTS; ++i)
+	{
+		float power = constrain(commandPower[i], -1, 1);
+		if(fabs(power) < outputDeadband) power = 0;
+
+		// Always write a transition to zero so that stopping a motor is never delayed
+		bool changed = (fabs(power - outputPower[i]) > outputChangeThreshold) || ((power == 0) && (outputPower[i] != 0));
+		bool expired = (timestampMicros - lastWriteTimestamp[i]) >= outputRefreshPeriod;
+
+		if(changed || expired)
+		{
+			motorControllers[i]->Set(power);
+			outputPower[i] = power;
+			lastWriteTimestamp[i] = timestampMicros;
+			++writesIssued;
+		}
+		else
+			++writesSuppressed;
+	}
+}
+
+void MotorOutput::reset()
+{
+	uint32_t timestampMicros = getTimestampMicros();
+	for(unsigned i = 0; i < NUM_MOTOR_OUTPUTS; ++i)
+	{
+		motorControllers[i]->Set(0);
+		commandPower[i] = 0;
+		outputPower[i] = 0;
+		lastWriteTimestamp[i] = timestampMicros;
+	}
+	staged = false;
+	lastCommitTimestamp = timestampMicros;
+	lastReportTimestamp = timestampMicros;
+}
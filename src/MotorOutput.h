@@ -0,0 +1,63 @@
+#ifndef SRC_MOTOROUTPUT_H_
+#define SRC_MOTOROUTPUT_H_
+
+#include <Constants.h>
+
+// Motor output channels: drive motors first, followed by manipulator joints
+const unsigned NUM_MOTOR_OUTPUTS = NUM_DRIVE_MOTORS + NUM_MANIPULATOR_JOINTS;
+
+/*
+ * Output stage for all motor controllers.
+ * Drive and Manipulator stage their motor commands here during their update,
+ * and the commands are written to the motor controllers in one batch when update() is called
+ * at the end of each robot loop. A batch is written only if new commands were staged or a refresh is due.
+ * Within a batch, a channel is only written to if its output changed by more than
+ * outputChangeThreshold or if it has not been written to for outputRefreshPeriod.
+ * The number of writes issued and suppressed is reported once per reportPeriod.
+ */
+
+class MotorOutput
+{
+	public:
+		MotorOutput();
+		void update();
+		void reset();
+		void setDrive(unsigned ch, float power) { if(ch < NUM_DRIVE_MOTORS) commandPower[ch] = power; staged = true; }
+		void setManipulator(unsigned ch, float power) { if(ch < NUM_MANIPULATOR_JOINTS) commandPower[NUM_DRIVE_MOTORS + ch] = power; staged = true; }
+		uint32_t getWritesIssued() { return writesIssued; }
+		uint32_t getWritesSuppressed() { return writesSuppressed; }
+
+	private:
+		// Motor commands smaller than this magnitude are output as zero
+		const float outputDeadband = 0.01;
+
+		// Minimum change in motor command before the motor controller is written to again
+		const float outputChangeThreshold = 0.005;
+
+		// Maximum time a motor controller can go without being written to, in microseconds
+		const uint32_t outputRefreshPeriod = 100 * 1000;
+
+		// Write count report period in microseconds
+		const uint32_t reportPeriod = 1000 * 1000;
+
+		std::shared_ptr<Victor> motorControllers[NUM_MOTOR_OUTPUTS];
+
+		float commandPower[NUM_MOTOR_OUTPUTS];
+		float outputPower[NUM_MOTOR_OUTPUTS];
+		uint32_t lastWriteTimestamp[NUM_MOTOR_OUTPUTS];
+
+		// Set when a motor command is staged, cleared when the batch is written
+		bool staged;
+		uint32_t lastCommitTimestamp;
+
+		// Number of motor controller writes performed and skipped since construction
+		uint32_t writesIssued;
+		uint32_t writesSuppressed;
+
+		// Totals at the last report
+		uint32_t reportedIssued;
+		uint32_t reportedSuppressed;
+		uint32_t lastReportTimestamp;
+};
+
+#endif /* SRC_MOTOROUTPUT_H_ */
@@ -0,0 +1,131 @@
+#include <RealTime.h>
+
+#include <alloca.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Touches a block of stack so its pages are mapped (and locked, after mlockall) before they are needed.
+ * @param size bytes of stack to touch
+ */
+static void __attribute__((noinline)) prefaultStack(size_t size)
+{
+	volatile char *buffer = (volatile char *)alloca(size);
+	for(size_t i = 0; i < size; i += 4096)
+		buffer[i] = 0;
+}
+
+RealTime::RealTime()
+{
+	enabled = false;
+	reset();
+}
+
+void RealTime::enable()
+{
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+		std::cout << "RealTime: mlockall failed (" << strerror(errno) << "), memory not locked" << std::endl;
+	prefaultStack(stackPrefault);
+
+	cpu_set_t cores;
+	CPU_ZERO(&cores);
+	CPU_SET(controlCore, &cores);
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) != 0)
+		std::cout << "RealTime: could not pin control thread to core " << controlCore << std::endl;
+
+	struct sched_param param;
+	param.sched_priority = controlPriority;
+	int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if(error != 0)
+		std::cout << "RealTime: SCHED_FIFO unavailable (" << strerror(error) << "), using normal scheduling" << std::endl;
+
+	// Only idle between iterations when the thread could otherwise starve the core
+	enabled = (error == 0);
+	reset();
+}
+
+void RealTime::begin()
+{
+	// Most iterations run no loop; only take a usage snapshot when one of the loops running in this mode may be due
+	// Loops check their period part way through the iteration, so look ahead by dueMargin
+	beginTimestamp = getTimestampMicros();
+	sampled = false;
+	for(unsigned i = 0; i < NUM_CONTROL_LOOPS && !sampled; ++i)
+	{
+		if(running[i] && (beginTimestamp - lastLoopTimestamp[i] + dueMargin >= loopPeriod[i]))
+		{
+			getrusage(RUSAGE_THREAD, &lastUsage);
+			sampled = true;
+		}
+	}
+}
+
+void RealTime::account(ControlLoops loop)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_THREAD, &usage);
+	if(sampled)
+	{
+		minorFaults[loop] += usage.ru_minflt - lastUsage.ru_minflt;
+		majorFaults[loop] += usage.ru_majflt - lastUsage.ru_majflt;
+		involuntarySwitches[loop] += usage.ru_nivcsw - lastUsage.ru_nivcsw;
+	}
+	lastUsage = usage;
+	sampled = true;
+
+	uint32_t interval = beginTimestamp - lastLoopTimestamp[loop];
+	if(running[loop] && (interval > loopPeriod[loop]))
+		maxLateness[loop] = std::max(maxLateness[loop], interval - loopPeriod[loop]);
+	lastLoopTimestamp[loop] = beginTimestamp;
+	running[loop] = true;
+}
+
+void RealTime::update()
+{
+	if(enabled)
+		usleep(idleMicros);
+
+	uint32_t timestampMicros = getTimestampMicros();
+	if(timestampMicros - lastRunTimestamp < reportPeriod) return;
+	lastRunTimestamp = timestampMicros;
+
+	// Packet length = 1 + 3 * 4 * 5 = 61
+	// Counts are plain numbers and lateness is in units of 100 us, all five digits so they do not clip in practice
+	std::string data = "RTIME:";
+	data += enabled ? "1" : "0";
+	for(unsigned i = 0; i < NUM_CONTROL_LOOPS; ++i)
+	{
+		data += countToString(minorFaults[i]);
+		data += countToString(majorFaults[i]);
+		data += countToString(involuntarySwitches[i]);
+		data += countToString(maxLateness[i] / 100);
+
+		minorFaults[i] = 0;
+		majorFaults[i] = 0;
+		involuntarySwitches[i] = 0;
+		maxLateness[i] = 0;
+	}
+	data += ":RTIME";
+	std::cout << data << std::endl;
+}
+
+void RealTime::reset()
+{
+	uint32_t timestampMicros = getTimestampMicros();
+	for(unsigned i = 0; i < NUM_CONTROL_LOOPS; ++i)
+	{
+		minorFaults[i] = 0;
+		majorFaults[i] = 0;
+		involuntarySwitches[i] = 0;
+		maxLateness[i] = 0;
+		lastLoopTimestamp[i] = timestampMicros;
+		running[i] = false;
+	}
+	beginTimestamp = timestampMicros;
+	sampled = false;
+	lastRunTimestamp = timestampMicros;
+}
@@ -0,0 +1,83 @@
+#ifndef SRC_REALTIME_H_
+#define SRC_REALTIME_H_
+
+#include <Constants.h>
+
+#include <sys/resource.h>
+
+// Assign IDs to the control loops for timing accounting
+enum ControlLoops
+{
+	SafetyLoop = 0,
+	DriveLoop,
+	ManipulatorLoop,
+	NUM_CONTROL_LOOPS
+};
+
+/*
+ * Real-time execution and per-loop timing accounting.
+ * All control loops run in the robot main thread in priority order (Safety first), so enable() gives
+ * that thread SCHED_FIFO priority, pins it to one core, locks and prefaults memory. Threads started
+ * before enable() (such as the BlackBox writer) keep normal scheduling.
+ * Page faults, involuntary context switches and lateness are accounted to the loop that incurred them
+ * and reported once per reportPeriod. Each iteration of the robot loop calls begin() first and account()
+ * after every control loop that ran; iterations in which no loop is due make no system calls.
+ */
+
+class RealTime
+{
+	public:
+		RealTime();
+		void enable();
+		void begin();
+		void account(ControlLoops loop);
+		void update();
+		void reset();
+
+	private:
+		// SCHED_FIFO priority of the control thread (1 to 99, above WPILib's default threads)
+		const int controlPriority = 50;
+
+		// CPU core the control thread is pinned to
+		const int controlCore = 1;
+
+		// Bytes of stack touched up front so that the loops never fault on stack growth
+		const size_t stackPrefault = 128 * 1024;
+
+		// Time slept between loop iterations in real-time mode so lower priority threads on the core can run
+		const uint32_t idleMicros = 500;
+
+		// How far ahead begin() looks for a loop falling due during the iteration, in microseconds
+		const uint32_t dueMargin = 2000;
+
+		// Timing report period in microseconds
+		const uint32_t reportPeriod = 1000 * 1000;
+
+		const uint32_t loopPeriod[NUM_CONTROL_LOOPS] =
+		{
+			safetyPeriod,
+			drivePeriod,
+			manipulatorPeriod
+		};
+
+		bool enabled;
+
+		// Start of the current loop iteration, and whether lastUsage was taken in it
+		uint32_t beginTimestamp;
+		bool sampled;
+		struct rusage lastUsage;
+
+		// Loops that have run since reset(), as not every loop runs in every mode
+		bool running[NUM_CONTROL_LOOPS];
+
+		// Counters since the last report
+		long minorFaults[NUM_CONTROL_LOOPS];
+		long majorFaults[NUM_CONTROL_LOOPS];
+		long involuntarySwitches[NUM_CONTROL_LOOPS];
+		uint32_t maxLateness[NUM_CONTROL_LOOPS];
+
+		uint32_t lastLoopTimestamp[NUM_CONTROL_LOOPS];
+		uint32_t lastRunTimestamp;
+};
+
+#endif /* SRC_REALTIME_H_ */
@@ -1,5 +1,9 @@
 #include <Constants.h>
+#include <RealTime.h>
+#include <BlackBox.h>
 #include <Safety.h>
+#include <MotorOutput.h>
+#include <AutonomyInterface.h>
 #include <Drive.h>
 #include <Manipulator.h>
 
@@ -11,48 +15,76 @@ private:
 	Joystick joystickDrive;
 	Joystick joystickManipulator;
 	PowerDistributionPanel pdp;
+	BlackBox blackBox;
 	Safety safety;
+	MotorOutput output;
+	AutonomyInterface autonomy;
 	Drive drive;
 	Manipulator manipulator;
+	RealTime realTime;
 
 public:
 	Robot() :
 			joystickDrive(0),
 			joystickManipulator(1),
 			pdp(),
-			safety(&joystickDrive, &joystickManipulator, &pdp),
-			drive(&joystickDrive, &safety),
-			manipulator(&joystickManipulator, &safety)
+			blackBox(),
+			safety(&joystickDrive, &joystickManipulator, &pdp, &blackBox),
+			output(),
+			autonomy(&safety),
+			drive(&joystickDrive, &safety, &output, &blackBox, &autonomy),
+			manipulator(&joystickManipulator, &safety, &output, &blackBox, &autonomy),
+			realTime()
 	{
 	}
 
 	void RobotInit()
 	{
+		if(realTimeMode) realTime.enable();
 		safety.reset();
+		output.reset();
+		autonomy.reset();
 		drive.reset();
 		manipulator.reset();
 	}
 
 	void Disabled()
 	{
+		blackBox.trigger(ModeChangeReason);
+		realTime.reset();
 		while (IsDisabled())
 		{
-			safety.update();
+			realTime.begin();
+			bool safetyRan = safety.update();
+			if(safetyRan) realTime.account(SafetyLoop);
 			drive.reset();
 			manipulator.reset();
+
+			// Drive and Manipulator do not run while disabled, so publish their sensor state at the Safety rate
+			if(safetyRan) autonomy.update();
+			output.update();
+			realTime.update();
 		}
 	}
 
 	void OperatorControl()
 	{
+		blackBox.trigger(ModeChangeReason);
 		safety.reset();
+		output.reset();
+		autonomy.reset();
 		drive.reset();
 		manipulator.reset();
+		realTime.reset();
 		while (IsOperatorControl() && IsEnabled())
 		{
-			safety.update();
-			drive.update();
-			manipulator.update();
+			realTime.begin();
+			if(safety.update()) realTime.account(SafetyLoop);
+			autonomy.update();
+			if(drive.update()) realTime.account(DriveLoop);
+			if(manipulator.update()) realTime.account(ManipulatorLoop);
+			output.update();
+			realTime.update();
 		}
 	}
 };
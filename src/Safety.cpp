@@ -1,20 +1,23 @@
 #include <Safety.h>
 
-Safety::Safety(Joystick *drive, Joystick *manipulator, PowerDistributionPanel *pdpanel)
+Safety::Safety(Joystick *drive, Joystick *manipulator, PowerDistributionPanel *pdpanel, BlackBox *recorder)
 {
 	powerRelay = std::make_shared<DigitalOutput>(relayPin);
 	powerRelay->Set(1);
+	relayEnabled = true;
+	relayEnabledTimestamp = getTimestampMicros() - tripEpisodePeriod;
 
 	this->joystickDrive = drive;
 	this->joystickManipulator = manipulator;
 	this->pdp = pdpanel;
+	this->blackBox = recorder;
 	reset();
 }
 
-void Safety::update()
+bool Safety::update()
 {
 	uint32_t timestampMicros = getTimestampMicros();
-	if(timestampMicros - lastRunTimestamp < safetyPeriod) return;
+	if(timestampMicros - lastRunTimestamp < safetyPeriod) return false;
 	lastRunTimestamp = timestampMicros;
 
 	// Get max current setting
@@ -26,43 +29,78 @@ void Safety::update()
 	for(unsigned i = 0; i < DriveMotors::NUM_DRIVE_MOTORS; ++i)
 	{
 		current = (float)(pdp->GetCurrent(drivePowerChannels[i]));
+		lastDriveCurrent[i] = current;
 		lastDriveSafetyCurrent[i] = ((1-currentSafetyFilter) * lastDriveSafetyCurrent[i]) + currentSafetyFilter * current;
 		lastDriveControlCurrent[i] = ((1-currentControlFilter) * lastDriveControlCurrent[i]) + currentControlFilter * current;
 
 		if (lastDriveSafetyCurrent[i] > maxCurrentDrive)
 		{
-			powerRelay->Set(0);
-			return;
+			setRelay(false, maxCurrentDrive, maxCurrentManipulator);
+			return true;
 		}
 	}
 	for(unsigned i = 0; i < ManipulatorJoints::NUM_MANIPULATOR_JOINTS; ++i)
 	{
 		current = (float)(pdp->GetCurrent(manipulatorPowerChannels[i]));
+		lastManipulatorCurrent[i] = current;
 		lastManipulatorSafetyCurrent[i] = ((1-currentSafetyFilter) * lastManipulatorSafetyCurrent[i]) + currentSafetyFilter * current;
 		lastManipulatorControlCurrent[i] = ((1-currentControlFilter) * lastManipulatorControlCurrent[i]) + currentControlFilter * current;
 
 		if (lastManipulatorSafetyCurrent[i] > maxCurrentManipulator)
 		{
-			powerRelay->Set(0);
-			return;
+			setRelay(false, maxCurrentDrive, maxCurrentManipulator);
+			return true;
 		}
 	}
 
-	powerRelay->Set(1);
+	setRelay(true, maxCurrentDrive, maxCurrentManipulator);
+	return true;
 }
 
 void Safety::reset()
 {
 	for(unsigned i = 0; i < DriveMotors::NUM_DRIVE_MOTORS; ++i)
 	{
+		lastDriveCurrent[i] = 0;
 		lastDriveSafetyCurrent[i] = 0;
 		lastDriveControlCurrent[i] = 0;
 	}
 	for(unsigned i = 0; i < ManipulatorJoints::NUM_MANIPULATOR_JOINTS; ++i)
 	{
+		lastManipulatorCurrent[i] = 0;
 		lastManipulatorSafetyCurrent[i] = 0;
 		lastManipulatorControlCurrent[i] = 0;
 	}
 	lastRunTimestamp = getTimestampMicros() - safetyPeriod;
 }
 
+void Safety::setRelay(bool enabled, float maxCurrentDrive, float maxCurrentManipulator)
+{
+	powerRelay->Set(enabled);
+
+	BlackBoxSafety state;
+	state.maxCurrentDrive = maxCurrentDrive;
+	state.maxCurrentManipulator = maxCurrentManipulator;
+	for(unsigned i = 0; i < DriveMotors::NUM_DRIVE_MOTORS; ++i)
+	{
+		state.driveCurrent[i] = lastDriveCurrent[i];
+		state.driveSafetyCurrent[i] = lastDriveSafetyCurrent[i];
+		state.driveControlCurrent[i] = lastDriveControlCurrent[i];
+	}
+	for(unsigned i = 0; i < ManipulatorJoints::NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		state.manipulatorCurrent[i] = lastManipulatorCurrent[i];
+		state.manipulatorSafetyCurrent[i] = lastManipulatorSafetyCurrent[i];
+		state.manipulatorControlCurrent[i] = lastManipulatorControlCurrent[i];
+	}
+	state.relayEnabled = enabled;
+	blackBox->record(state);
+
+	// Dump the recent history when the relay trips, once per trip episode
+	uint32_t timestampMicros = getTimestampMicros();
+	if(relayEnabled && !enabled && (timestampMicros - relayEnabledTimestamp >= tripEpisodePeriod))
+		blackBox->trigger(RelayTripReason);
+	if(!relayEnabled && enabled)
+		relayEnabledTimestamp = timestampMicros;
+	relayEnabled = enabled;
+}
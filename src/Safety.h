@@ -2,15 +2,17 @@
 #define SRC_SAFETY_H_
 
 #include <Constants.h>
+#include <BlackBox.h>
 
 class Safety
 {
 	public:
-		Safety(Joystick *drive, Joystick *manipulator, PowerDistributionPanel *pdpanel);
-		void update();
+		Safety(Joystick *drive, Joystick *manipulator, PowerDistributionPanel *pdpanel, BlackBox *recorder);
+		bool update();
 		void reset();
 		float getDriveCurrent(unsigned ch) { return (ch < NUM_DRIVE_MOTORS) ? lastDriveControlCurrent[ch] : 0; }
 		float getManipulatorCurrent(unsigned ch) { return (ch < NUM_MANIPULATOR_JOINTS) ? lastManipulatorControlCurrent[ch] : 0; }
+		bool getRelayEnabled() { return relayEnabled; }
 
 	private:
 		// Maximum current that any motor is allowed to reach to, upper and lower bounds, adjusted by throttle
@@ -25,16 +27,27 @@ class Safety
 		const float currentSafetyFilter = 0.2;
 		const float currentControlFilter = 0.7;
 
+		// After a trip the relay is re-enabled as soon as the current falls and may trip again on the next cycles;
+		// trips within this long (in microseconds) of the relay being re-enabled are part of the same episode and not dumped
+		const uint32_t tripEpisodePeriod = 5 * 1000 * 1000;
+
+		float lastDriveCurrent[NUM_DRIVE_MOTORS];
+		float lastManipulatorCurrent[NUM_MANIPULATOR_JOINTS];
 		float lastDriveSafetyCurrent[NUM_DRIVE_MOTORS];
 		float lastManipulatorSafetyCurrent[NUM_MANIPULATOR_JOINTS];
 		float lastDriveControlCurrent[NUM_DRIVE_MOTORS];
 		float lastManipulatorControlCurrent[NUM_MANIPULATOR_JOINTS];
 
 		std::shared_ptr<DigitalOutput> powerRelay;
+		bool relayEnabled;
+		uint32_t relayEnabledTimestamp;
 		uint32_t lastRunTimestamp;
 		Joystick *joystickDrive;
 		Joystick *joystickManipulator;
 		PowerDistributionPanel *pdp;
+		BlackBox *blackBox;
+
+		void setRelay(bool enabled, float maxCurrentDrive, float maxCurrentManipulator);
 };
 
 #endif /* SRC_SAFETY_H_ */
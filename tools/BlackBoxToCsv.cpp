@@ -0,0 +1,164 @@
+/*
+ * Host tool converting black box dumps (see src/BlackBox.h) to CSV.
+ * Writes <dump>.safety.csv, <dump>.drive.csv and <dump>.manipulator.csv next to the dump.
+ *
+ * Build: g++ -std=c++1y -I../src -o BlackBoxToCsv BlackBoxToCsv.cpp
+ * Usage: BlackBoxToCsv blackbox_relay_0.bin [more dumps...]
+ */
+
+#include <BlackBoxFormat.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a column header for an array field, one column per element.
+ * @param out output stream
+ * @param name field name
+ * @param count number of elements
+ */
+static void writeHeader(std::ostream &out, const char *name, unsigned count)
+{
+	for(unsigned i = 0; i < count; ++i)
+		out << "," << name << i;
+}
+
+/**
+ * Writes the values of an array field.
+ * @param out output stream
+ * @param values array values
+ * @param count number of elements
+ */
+template <typename T>
+static void writeValues(std::ostream &out, const T *values, unsigned count)
+{
+	for(unsigned i = 0; i < count; ++i)
+		out << "," << values[i];
+}
+
+static bool convert(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	BlackBoxHeader header;
+	if(!in.read((char *)&header, sizeof(header)) || header.magic != blackBoxMagic)
+	{
+		std::cerr << path << ": not a black box dump" << std::endl;
+		return false;
+	}
+	if(header.version != blackBoxVersion || header.frameSize != sizeof(BlackBoxFrame))
+	{
+		std::cerr << path << ": dump version " << header.version << " (frame size " << header.frameSize
+				<< ") does not match this tool" << std::endl;
+		return false;
+	}
+
+	std::vector<BlackBoxFrame> frames(header.frameCount);
+	if(!in.read((char *)frames.data(), frames.size() * sizeof(BlackBoxFrame)))
+	{
+		std::cerr << path << ": truncated dump" << std::endl;
+		return false;
+	}
+
+	const char *reasonNames[] = {"relay trip", "mode change", "crash signal"};
+	std::cout << path << ": " << header.frameCount << " frames, reason "
+			<< ((header.reason <= CrashSignalReason) ? reasonNames[header.reason] : "unknown")
+			<< " at " << header.triggerTimestamp << " us" << std::endl;
+
+	std::ofstream safety(path + ".safety.csv");
+	safety << "timestamp,maxCurrentDrive,maxCurrentManipulator";
+	writeHeader(safety, "driveCurrent", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(safety, "driveSafetyCurrent", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(safety, "driveControlCurrent", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(safety, "manipulatorCurrent", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(safety, "manipulatorSafetyCurrent", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(safety, "manipulatorControlCurrent", BLACKBOX_MANIPULATOR_JOINTS);
+	safety << ",relayEnabled\n";
+
+	std::ofstream drive(path + ".drive.csv");
+	drive << "timestamp";
+	writeHeader(drive, "axis", BLACKBOX_JOYSTICK_AXES);
+	drive << ",buttons,maxCurrent,leftSpeed,rightSpeed,adjLeftSpeed,adjRightSpeed";
+	writeHeader(drive, "encoder", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(drive, "motorSpeed", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(drive, "lastPower", BLACKBOX_DRIVE_MOTORS);
+	writeHeader(drive, "capPower", BLACKBOX_DRIVE_MOTORS);
+	drive << ",distanceTravelled\n";
+
+	std::ofstream manipulator(path + ".manipulator.csv");
+	manipulator << "timestamp";
+	writeHeader(manipulator, "axis", BLACKBOX_JOYSTICK_AXES);
+	manipulator << ",buttons,maxCurrent";
+	writeHeader(manipulator, "destPosition", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "trackPosition", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "jointPosition", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "jointNoise", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "lastSpeed", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "lastPower", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "lastError", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "capPower", BLACKBOX_MANIPULATOR_JOINTS);
+	writeHeader(manipulator, "cartesianTarget", BLACKBOX_CARTESIAN_AXES);
+	manipulator << "\n";
+
+	for(const BlackBoxFrame &frame : frames)
+	{
+		if(frame.source == SafetySource)
+		{
+			const BlackBoxSafety &s = frame.safety;
+			safety << frame.timestamp << "," << s.maxCurrentDrive << "," << s.maxCurrentManipulator;
+			writeValues(safety, s.driveCurrent, BLACKBOX_DRIVE_MOTORS);
+			writeValues(safety, s.driveSafetyCurrent, BLACKBOX_DRIVE_MOTORS);
+			writeValues(safety, s.driveControlCurrent, BLACKBOX_DRIVE_MOTORS);
+			writeValues(safety, s.manipulatorCurrent, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(safety, s.manipulatorSafetyCurrent, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(safety, s.manipulatorControlCurrent, BLACKBOX_MANIPULATOR_JOINTS);
+			safety << "," << s.relayEnabled << "\n";
+		}
+		else if(frame.source == DriveSource)
+		{
+			const BlackBoxDrive &d = frame.drive;
+			drive << frame.timestamp;
+			writeValues(drive, d.axes, BLACKBOX_JOYSTICK_AXES);
+			drive << "," << d.buttons << "," << d.maxCurrent << "," << d.leftSpeed << "," << d.rightSpeed
+					<< "," << d.adjLeftSpeed << "," << d.adjRightSpeed;
+			writeValues(drive, d.encoder, BLACKBOX_DRIVE_MOTORS);
+			writeValues(drive, d.motorSpeed, BLACKBOX_DRIVE_MOTORS);
+			writeValues(drive, d.lastPower, BLACKBOX_DRIVE_MOTORS);
+			writeValues(drive, d.capPower, BLACKBOX_DRIVE_MOTORS);
+			drive << "," << d.distanceTravelled << "\n";
+		}
+		else if(frame.source == ManipulatorSource)
+		{
+			const BlackBoxManipulator &m = frame.manipulator;
+			manipulator << frame.timestamp;
+			writeValues(manipulator, m.axes, BLACKBOX_JOYSTICK_AXES);
+			manipulator << "," << m.buttons << "," << m.maxCurrent;
+			writeValues(manipulator, m.destPosition, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.trackPosition, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.jointPosition, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.jointNoise, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.lastSpeed, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.lastPower, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.lastError, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.capPower, BLACKBOX_MANIPULATOR_JOINTS);
+			writeValues(manipulator, m.cartesianTarget, BLACKBOX_CARTESIAN_AXES);
+			manipulator << "\n";
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <dump.bin> [more dumps...]" << std::endl;
+		return 1;
+	}
+
+	bool ok = true;
+	for(int i = 1; i < argc; ++i)
+		ok = convert(argv[i]) && ok;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include <TelemetryDecoder.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+static const char driveStart[] = "DRIVE:";
+static const char driveEnd[] = ":DRIVE";
+static const char manipulatorStart[] = "MANIP:";
+static const char manipulatorEnd[] = ":MANIP";
+static const size_t markerLength = 6;
+
+/**
+ * Decodes a single numToString field.
+ * @param data first character of the field
+ * @param value output value in hundredths
+ * @return true if the field was well formed
+ */
+static inline bool decodeField(const char *data, int8_t &value)
+{
+	unsigned tens = (unsigned char)data[1] - '0';
+	unsigned ones = (unsigned char)data[2] - '0';
+	if(tens > 9 || ones > 9 || (data[0] != '+' && data[0] != '-')) return false;
+	int n = tens * 10 + ones;
+	value = (int8_t)((data[0] == '-') ? -n : n);
+	return true;
+}
+
+bool decodeFields(const char *data, unsigned count, int8_t *values)
+{
+	unsigned i = 0;
+
+#ifdef __SSSE3__
+	// Gather the sign, tens and ones characters of five fields (15 bytes) into separate lanes
+	const __m128i signShuffle = _mm_setr_epi8(0, 3, 6, 9, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i tensShuffle = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i onesShuffle = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i plus = _mm_set1_epi8('+');
+	const __m128i minus = _mm_set1_epi8('-');
+	const __m128i lanes = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+	// Each load reads 16 bytes for 15 bytes of fields, so stop while at least one more byte follows
+	for(; i + 5 < count; i += 5)
+	{
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(data + 3 * i));
+		__m128i sign = _mm_shuffle_epi8(chunk, signShuffle);
+		__m128i tens = _mm_sub_epi8(_mm_shuffle_epi8(chunk, tensShuffle), zero);
+		__m128i ones = _mm_sub_epi8(_mm_shuffle_epi8(chunk, onesShuffle), zero);
+
+		// Digits are valid if they are unchanged by an unsigned min with 9, signs if they are '+' or '-'
+		__m128i negative = _mm_cmpeq_epi8(sign, minus);
+		__m128i valid = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(tens, nine), tens), _mm_cmpeq_epi8(_mm_min_epu8(ones, nine), ones));
+		valid = _mm_and_si128(valid, _mm_or_si128(negative, _mm_cmpeq_epi8(sign, plus)));
+		if((_mm_movemask_epi8(_mm_and_si128(valid, lanes)) & 0x1F) != 0x1F) return false;
+
+		// value = tens * 10 + ones, negated where the sign is '-'
+		__m128i tens2 = _mm_add_epi8(tens, tens);
+		__m128i tens8 = _mm_add_epi8(_mm_add_epi8(tens2, tens2), _mm_add_epi8(tens2, tens2));
+		__m128i value = _mm_add_epi8(_mm_add_epi8(tens8, tens2), ones);
+		value = _mm_sub_epi8(_mm_xor_si128(value, negative), negative);
+
+		int8_t decoded[16];
+		_mm_storeu_si128((__m128i *)decoded, value);
+		memcpy(values + i, decoded, 5);
+	}
+#endif
+
+	for(; i < count; ++i)
+		if(!decodeField(data + 3 * i, values[i])) return false;
+	return true;
+}
+
+TelemetryDecoder::TelemetryDecoder()
+{
+	malformedLines = 0;
+}
+
+size_t TelemetryDecoder::decode(const char *data, size_t size)
+{
+	const char *position = data;
+	const char *end = data + size;
+
+	while(position < end)
+	{
+		const char *lineEnd = (const char *)memchr(position, '\n', end - position);
+		if(lineEnd == nullptr) break;
+
+		// Packets may be preceded by console prefixes, so search the whole line for the start marker
+		size_t length = lineEnd - position;
+		const char *packet = (const char *)memmem(position, length, driveStart, markerLength);
+		if(packet != nullptr)
+		{
+			if(!decodeDrive(packet + markerLength, lineEnd)) ++malformedLines;
+		}
+		else if((packet = (const char *)memmem(position, length, manipulatorStart, markerLength)) != nullptr)
+		{
+			if(!decodeManipulator(packet + markerLength, lineEnd)) ++malformedLines;
+		}
+		position = lineEnd + 1;
+	}
+	return position - data;
+}
+
+void TelemetryDecoder::clear()
+{
+	for(unsigned i = 0; i < NUM_DRIVE_FIELDS; ++i)
+		drive.field[i].clear();
+	drive.distance.clear();
+	for(unsigned i = 0; i < NUM_MANIPULATOR_FIELDS; ++i)
+		manipulator.field[i].clear();
+	manipulator.fieldCount.clear();
+}
+
+bool TelemetryDecoder::decodeDrive(const char *begin, const char *end)
+{
+	// 34 fields followed by the zero padded distance (at least 6 digits) and the end marker
+	const char *distance = begin + 3 * NUM_DRIVE_FIELDS;
+	if(end - distance < 6 + (ptrdiff_t)markerLength) return false;
+
+	int8_t values[NUM_DRIVE_FIELDS];
+	if(!decodeFields(begin, NUM_DRIVE_FIELDS, values)) return false;
+
+	uint32_t centimeters = 0;
+	const char *digit = distance;
+	for(; digit < end && *digit >= '0' && *digit <= '9'; ++digit)
+		centimeters = centimeters * 10 + (*digit - '0');
+	if(digit - distance < 6 || end - digit < (ptrdiff_t)markerLength || memcmp(digit, driveEnd, markerLength) != 0) return false;
+
+	for(unsigned i = 0; i < NUM_DRIVE_FIELDS; ++i)
+		drive.field[i].push_back(values[i]);
+	drive.distance.push_back(centimeters);
+	return true;
+}
+
+bool TelemetryDecoder::decodeManipulator(const char *begin, const char *end)
+{
+	// The field count depends on the robot code version, so find the end marker and check it against each layout
+	const char *marker = (const char *)memmem(begin, end - begin, manipulatorEnd, markerLength);
+	if(marker == nullptr || (marker - begin) % 3 != 0) return false;
+	unsigned count = (marker - begin) / 3;
+	if(std::find(std::begin(manipulatorLayouts), std::end(manipulatorLayouts), count) == std::end(manipulatorLayouts)) return false;
+
+	int8_t values[NUM_MANIPULATOR_FIELDS] = {0};
+	if(!decodeFields(begin, count, values)) return false;
+
+	for(unsigned i = 0; i < NUM_MANIPULATOR_FIELDS; ++i)
+		manipulator.field[i].push_back(values[i]);
+	manipulator.fieldCount.push_back((uint8_t)count);
+	return true;
+}
+
+TelemetryAggregator::TelemetryAggregator(unsigned windowSamples)
+{
+	window = (windowSamples > 0) ? windowSamples : 1;
+	for(unsigned i = 0; i < TELEMETRY_DRIVE_MOTORS; ++i)
+	{
+		drive[i] = MotorStatistics();
+		driveHistory[i].assign(window, 0);
+		driveWindowSum[i] = 0;
+	}
+	for(unsigned i = 0; i < TELEMETRY_MANIPULATOR_JOINTS; ++i)
+	{
+		manipulator[i] = MotorStatistics();
+		manipulatorHistory[i].assign(window, 0);
+		manipulatorWindowSum[i] = 0;
+	}
+	driveRows = 0;
+	manipulatorRows = 0;
+	lastDistance = 0;
+	distanceTravelled = 0;
+	sessions = 0;
+}
+
+void TelemetryAggregator::add(MotorStatistics &stats, std::vector<int8_t> &history, int &windowSum, uint64_t row, int current, bool atCap)
+{
+	++stats.samples;
+	stats.currentSum += current;
+	stats.peakCurrent = std::max(stats.peakCurrent, current);
+	if(atCap) ++stats.samplesAtCap;
+
+	int8_t &oldest = history[row % window];
+	windowSum += current - oldest;
+	oldest = (int8_t)current;
+	stats.windowMean = (double)windowSum / std::min<uint64_t>(row + 1, window);
+}
+
+void TelemetryAggregator::update(const TelemetryDecoder &decoder)
+{
+	const DriveColumns &d = decoder.drive;
+	for(size_t row = 0; row < d.rows(); ++row, ++driveRows)
+	{
+		uint32_t distance = d.distance[row];
+		if(driveRows == 0 || distance < lastDistance)
+			++sessions;
+		else
+			distanceTravelled += distance - lastDistance;
+		lastDistance = distance;
+
+		bool enabled = d.field[DriveEnableField][row] != 0;
+		for(unsigned i = 0; i < TELEMETRY_DRIVE_MOTORS; ++i)
+		{
+			int power = std::abs(d.field[DrivePowerField + i][row]);
+			bool atCap = enabled && power >= d.field[DriveCapPowerField + i][row];
+			add(drive[i], driveHistory[i], driveWindowSum[i], driveRows, d.field[DriveCurrentField + i][row], atCap);
+		}
+	}
+
+	const ManipulatorColumns &m = decoder.manipulator;
+	for(size_t row = 0; row < m.rows(); ++row, ++manipulatorRows)
+	{
+		bool enabled = m.field[ManipulatorEnableField][row] != 0;
+		for(unsigned i = 0; i < TELEMETRY_MANIPULATOR_JOINTS; ++i)
+		{
+			int power = std::abs(m.field[ManipulatorPowerField + i][row]);
+			bool atCap = enabled && power >= m.field[ManipulatorCapPowerField + i][row];
+			add(manipulator[i], manipulatorHistory[i], manipulatorWindowSum[i], manipulatorRows, m.field[ManipulatorCurrentField + i][row], atCap);
+		}
+	}
+}
+
+void TelemetryAggregator::print(std::ostream &out) const
+{
+	out << std::fixed << std::setprecision(2);
+	out << "Drive: " << driveRows << " packets (" << driveRows * telemetryDrivePeriod << " s), distance "
+			<< distanceTravelled << " cm over " << sessions << " session" << (sessions == 1 ? "" : "s") << std::endl;
+	for(unsigned i = 0; i < TELEMETRY_DRIVE_MOTORS; ++i)
+		out << "  motor " << i << ": mean " << drive[i].meanCurrent() << " A, peak " << drive[i].peakCurrent
+				<< " A, window mean " << drive[i].windowMean << " A, at cap " << drive[i].samplesAtCap * telemetryDrivePeriod << " s" << std::endl;
+
+	out << "Manipulator: " << manipulatorRows << " packets (" << manipulatorRows * telemetryManipulatorPeriod << " s)" << std::endl;
+	for(unsigned i = 0; i < TELEMETRY_MANIPULATOR_JOINTS; ++i)
+		out << "  joint " << i << ": mean " << manipulator[i].meanCurrent() << " A, peak " << manipulator[i].peakCurrent
+				<< " A, window mean " << manipulator[i].windowMean << " A, at cap " << manipulator[i].samplesAtCap * telemetryManipulatorPeriod << " s" << std::endl;
+}
@@ -0,0 +1,155 @@
+#ifndef TOOLS_TELEMETRYDECODER_H_
+#define TOOLS_TELEMETRYDECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iosfwd>
+#include <vector>
+
+/*
+ * Ground station decoder for the DRIVE:...:DRIVE and MANIP:...:MANIP telemetry lines.
+ * Lines are parsed in place (no copies) from any buffer, such as a memory-mapped log, into columnar arrays.
+ * Every numToString field is stored as its integer value in hundredths (-99 to +99), so the original
+ * value is column[row] / 100.0. Field order must match Drive::update() and Manipulator::update().
+ * MANIP packets from older robot code without the noise fields (39 fields) or without the Cartesian and
+ * solve time fields (44 fields) are also accepted; their missing columns are left at zero.
+ */
+
+// Loop periods in seconds (drivePeriod and manipulatorPeriod in src/Constants.h)
+const double telemetryDrivePeriod = 0.050;
+const double telemetryManipulatorPeriod = 0.025;
+
+const unsigned TELEMETRY_DRIVE_MOTORS = 6;
+const unsigned TELEMETRY_MANIPULATOR_JOINTS = 5;
+
+// First column of each DRIVE packet field (array fields span one column per motor)
+enum DriveFields
+{
+	DriveEnableField = 0,
+	DriveRunField = 1,
+	DriveOverrideField = 2,
+	DriveMaxCurrentField = 3, // Amps / 100
+	DriveForwardField = 4,
+	DriveTurnField = 5,
+	DriveLeftSpeedField = 6,
+	DriveRightSpeedField = 7,
+	DriveAdjLeftSpeedField = 8,
+	DriveAdjRightSpeedField = 9,
+	DriveMotorSpeedField = 10,
+	DrivePowerField = 16,
+	DriveCurrentField = 22, // Amps / 100
+	DriveCapPowerField = 28,
+	NUM_DRIVE_FIELDS = 34
+};
+
+// First column of each MANIP packet field (array fields span one column per joint)
+enum ManipulatorFields
+{
+	ManipulatorEnableField = 0,
+	ManipulatorRunField = 1,
+	ManipulatorControllableField = 2,
+	ManipulatorMaxCurrentField = 3, // Amps / 100
+	ManipulatorDestPositionField = 4,
+	ManipulatorTrackPositionField = 9,
+	ManipulatorJointPositionField = 14,
+	ManipulatorSpeedField = 19,
+	ManipulatorPowerField = 24,
+	ManipulatorCurrentField = 29, // Amps / 100
+	ManipulatorCapPowerField = 34,
+	ManipulatorNoiseField = 39, // Degrees / 10
+	ManipulatorCartesianField = 44,
+	ManipulatorSolveTimeField = 45, // Microseconds / 100
+	NUM_MANIPULATOR_FIELDS = 46
+};
+
+// Field counts of every MANIP packet layout accepted, oldest first
+const unsigned manipulatorLayouts[] = {ManipulatorNoiseField, ManipulatorCartesianField, NUM_MANIPULATOR_FIELDS};
+
+struct DriveColumns
+{
+	std::vector<int8_t> field[NUM_DRIVE_FIELDS];
+	std::vector<uint32_t> distance; // Centimeters
+	size_t rows() const { return distance.size(); }
+};
+
+struct ManipulatorColumns
+{
+	std::vector<int8_t> field[NUM_MANIPULATOR_FIELDS];
+	std::vector<uint8_t> fieldCount; // Fields present in each packet; columns from here on are zero
+	size_t rows() const { return fieldCount.size(); }
+};
+
+class TelemetryDecoder
+{
+	public:
+		TelemetryDecoder();
+		size_t decode(const char *data, size_t size);
+		void clear();
+
+		DriveColumns drive;
+		ManipulatorColumns manipulator;
+
+		// Lines containing a packet marker that failed to parse
+		uint64_t malformedLines;
+
+	private:
+		bool decodeDrive(const char *begin, const char *end);
+		bool decodeManipulator(const char *begin, const char *end);
+};
+
+/**
+ * Decodes consecutive three character numToString fields ("+42", "-07") into hundredths.
+ * Uses SSSE3 when available to decode five fields per instruction sequence.
+ * @param data first character of the first field
+ * @param count number of fields
+ * @param values output values in hundredths (-99 to +99)
+ * @return true if every field was well formed
+ */
+bool decodeFields(const char *data, unsigned count, int8_t *values);
+
+/*
+ * Rolling statistics over decoded telemetry.
+ * update() consumes every row currently in the decoder; when streaming, clear the decoder after each
+ * update() so that rows are not counted twice.
+ */
+
+struct MotorStatistics
+{
+	uint64_t samples;
+	double currentSum; // Amps
+	int peakCurrent; // Amps
+	uint64_t samplesAtCap; // Enabled samples with power pinned at capPower
+	double windowMean; // Mean current over the last window samples, in amps
+
+	double meanCurrent() const { return samples ? currentSum / samples : 0; }
+};
+
+class TelemetryAggregator
+{
+	public:
+		TelemetryAggregator(unsigned windowSamples);
+		void update(const TelemetryDecoder &decoder);
+		void print(std::ostream &out) const;
+
+		MotorStatistics drive[TELEMETRY_DRIVE_MOTORS];
+		MotorStatistics manipulator[TELEMETRY_MANIPULATOR_JOINTS];
+		uint64_t driveRows;
+		uint64_t manipulatorRows;
+		uint32_t lastDistance;
+
+		// Sum of the increases in distance; a decrease means Drive::reset() started a new session
+		uint64_t distanceTravelled;
+		unsigned sessions;
+
+	private:
+		unsigned window;
+		std::vector<int8_t> driveHistory[TELEMETRY_DRIVE_MOTORS];
+		std::vector<int8_t> manipulatorHistory[TELEMETRY_MANIPULATOR_JOINTS];
+		int driveWindowSum[TELEMETRY_DRIVE_MOTORS];
+		int manipulatorWindowSum[TELEMETRY_MANIPULATOR_JOINTS];
+
+		void add(MotorStatistics &stats, std::vector<int8_t> &history, int &windowSum, uint64_t row, int current, bool atCap);
+};
+
+#endif /* TOOLS_TELEMETRYDECODER_H_ */
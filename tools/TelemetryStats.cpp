@@ -0,0 +1,139 @@
+/*
+ * Ground station tool summarising DRIVE and MANIP telemetry (see TelemetryDecoder.h).
+ * A log file is memory-mapped and decoded in place; stdin and UDP (netconsole, port 6666) are streamed.
+ *
+ * Build: g++ -std=c++1y -O2 -march=native -I. -o TelemetryStats TelemetryStats.cpp TelemetryDecoder.cpp
+ * Usage: TelemetryStats <log file> | - | --udp <port>  [--window <samples>]
+ */
+
+#include <TelemetryDecoder.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Streamed input is aggregated and the decoder cleared every this many bytes
+static const size_t streamBufferSize = 1 << 20;
+
+// Streamed summaries are printed every this many drive packets (one minute of driving)
+static const uint64_t streamReportRows = 1200;
+
+static int decodeFile(const char *path, TelemetryAggregator &aggregator)
+{
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+	if(fd < 0 || fstat(fd, &info) != 0)
+	{
+		std::cerr << path << ": " << strerror(errno) << std::endl;
+		return 1;
+	}
+
+	TelemetryDecoder decoder;
+	size_t size = info.st_size;
+	auto start = std::chrono::steady_clock::now();
+	if(size > 0)
+	{
+		void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping == MAP_FAILED)
+		{
+			std::cerr << path << ": " << strerror(errno) << std::endl;
+			close(fd);
+			return 1;
+		}
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		decoder.decode((const char *)mapping, size);
+		munmap(mapping, size);
+	}
+	close(fd);
+	aggregator.update(decoder);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	aggregator.print(std::cout);
+	std::cout << "Decoded " << size / 1e6 << " MB in " << seconds << " s (" << (seconds > 0 ? size / 1e6 / seconds : 0)
+			<< " MB/s), " << decoder.malformedLines << " malformed lines" << std::endl;
+	return 0;
+}
+
+static int decodeStream(int fd, bool datagrams, TelemetryAggregator &aggregator)
+{
+	TelemetryDecoder decoder;
+	std::vector<char> buffer(2 * streamBufferSize);
+	size_t filled = 0;
+	uint64_t nextReport = streamReportRows;
+
+	while(true)
+	{
+		ssize_t received = datagrams ? recv(fd, buffer.data() + filled, buffer.size() - filled, 0)
+				: read(fd, buffer.data() + filled, buffer.size() - filled);
+		if(received <= 0) break;
+		filled += received;
+
+		// Decode complete lines and keep any partial line for the next read
+		size_t consumed = decoder.decode(buffer.data(), filled);
+		memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+		filled -= consumed;
+		if(filled == buffer.size()) filled = 0; // Line longer than the buffer, drop it
+
+		aggregator.update(decoder);
+		decoder.clear();
+		if(aggregator.driveRows >= nextReport)
+		{
+			aggregator.print(std::cout);
+			nextReport = aggregator.driveRows + streamReportRows;
+		}
+	}
+
+	aggregator.print(std::cout);
+	std::cout << decoder.malformedLines << " malformed lines" << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	std::string source;
+	int port = -1;
+	unsigned window = 20;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if(arg == "--udp" && i + 1 < argc) port = atoi(argv[++i]);
+		else if(arg == "--window" && i + 1 < argc) window = atoi(argv[++i]);
+		else source = arg;
+	}
+	if(source.empty() && port < 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " <log file> | - | --udp <port>  [--window <samples>]" << std::endl;
+		return 1;
+	}
+
+	TelemetryAggregator aggregator(window);
+	if(port >= 0)
+	{
+		int fd = socket(AF_INET, SOCK_DGRAM, 0);
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons(port);
+		if(fd < 0 || bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+		{
+			std::cerr << "UDP port " << port << ": " << strerror(errno) << std::endl;
+			return 1;
+		}
+		return decodeStream(fd, true, aggregator);
+	}
+	if(source == "-")
+		return decodeStream(STDIN_FILENO, false, aggregator);
+	return decodeFile(source.c_str(), aggregator);
+}
@@ -0,0 +1,244 @@
+/*
+ * Host test of the autonomy shared memory mailbox (src/AutonomyShared.h).
+ * Forks a stand-in autonomy process that maps its own copy of the shared memory block. The robot side publishes
+ * state and the autonomy side echoes each state back as a command, as the real processes would, while both
+ * check every block they read for torn writes and time their seqlockRead/seqlockWrite calls.
+ *
+ * Reported: one way latency (state published to state read by the other process), round trip latency
+ * (state published to the echoed command read back), per-call read and write cost, and read retries exhausted.
+ * The exit status is 1 if a torn block was ever returned or the echo stopped.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++1y -O2 -pthread -Isrc -o AutonomyLatency tools/soak/AutonomyLatency.cpp -lrt
+ * Usage: AutonomyLatency [round trips]
+ */
+
+#include <AutonomyShared.h>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Separate from autonomySharedName so that a running robot program is not disturbed
+static const char testSharedName[] = "/overkill_autonomy_latency";
+
+// Give up on an echo after this long, in nanoseconds
+static const uint64_t echoTimeout = 1000 * 1000 * 1000;
+
+// Both sides mark the test stop in these fields
+static const uint32_t stopFlag = 1u << 31;
+
+static uint64_t nanos()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Every field of a block carries the same stamp so that a torn read shows up as a mismatch
+static void fill(AutonomyStateData &state, uint64_t stamp)
+{
+	state.timestampMicros = stamp;
+	for(unsigned i = 0; i < AUTONOMY_DRIVE_MOTORS; ++i)
+	{
+		state.encoder[i] = (int32_t)stamp;
+		state.motorSpeed[i] = state.driveCurrent[i] = (float)(stamp % 1000000);
+	}
+	for(unsigned i = 0; i < AUTONOMY_MANIPULATOR_JOINTS; ++i)
+		state.jointPosition[i] = state.manipulatorCurrent[i] = (float)(stamp % 1000000);
+	state.distanceTravelled = (float)(stamp % 1000000);
+	state.relayEnabled = (uint32_t)stamp;
+}
+
+static bool consistent(const AutonomyStateData &state)
+{
+	bool ok = state.relayEnabled == (uint32_t)state.timestampMicros;
+	for(unsigned i = 0; i < AUTONOMY_DRIVE_MOTORS; ++i)
+		ok = ok && (state.encoder[i] == (int32_t)state.timestampMicros) && (state.motorSpeed[i] == state.distanceTravelled)
+				&& (state.driveCurrent[i] == state.distanceTravelled);
+	for(unsigned i = 0; i < AUTONOMY_MANIPULATOR_JOINTS; ++i)
+		ok = ok && (state.jointPosition[i] == state.distanceTravelled) && (state.manipulatorCurrent[i] == state.distanceTravelled);
+	return ok;
+}
+
+static void fill(AutonomyCommandData &command, uint64_t stamp)
+{
+	command.flags = 0;
+	command.leaseMicros = (uint32_t)stamp;
+	command.timestampMicros = stamp;
+	command.forwardSpeed = command.turnSpeed = (float)(stamp % 1000000);
+	for(unsigned i = 0; i < AUTONOMY_MANIPULATOR_JOINTS; ++i)
+		command.jointPosition[i] = (float)(stamp % 1000000);
+}
+
+static bool consistent(const AutonomyCommandData &command)
+{
+	bool ok = (command.leaseMicros == (uint32_t)command.timestampMicros) && (command.turnSpeed == command.forwardSpeed);
+	for(unsigned i = 0; i < AUTONOMY_MANIPULATOR_JOINTS; ++i)
+		ok = ok && (command.jointPosition[i] == command.forwardSpeed);
+	return ok;
+}
+
+// Per-side measurements, kept in the shared block so the parent can report the child's
+struct SideResults
+{
+	uint64_t reads, failedReads, tornReads;
+	uint64_t readNanos, writes, writeNanos;
+	uint64_t maxReadNanos, maxWriteNanos;
+};
+
+struct TestShared
+{
+	AutonomyShared mailbox;
+	SideResults autonomySide;
+	uint32_t oneWayNanos[1]; // Followed by one entry per round trip, written by the autonomy side
+};
+
+// Spins on a read, timing each call, until the predicate accepts the data or the timeout passes
+template <typename T, typename Accept>
+static bool poll(const AutonomySeqlock<T> &block, T &data, SideResults &results, Accept accept)
+{
+	uint64_t start = nanos();
+	for(unsigned spins = 1; ; ++spins)
+	{
+		uint64_t before = nanos();
+		bool ok = seqlockRead(block, data);
+		uint64_t elapsed = nanos() - before;
+		++results.reads;
+		results.readNanos += elapsed;
+		results.maxReadNanos = std::max(results.maxReadNanos, elapsed);
+		if(!ok) ++results.failedReads;
+		else if(!consistent(data)) ++results.tornReads;
+		else if(accept(data)) return true;
+
+		if(before - start > echoTimeout) return false;
+		if(spins % 1000 == 0) sched_yield(); // Let the other side run when they share a core
+	}
+}
+
+template <typename T>
+static void timedWrite(AutonomySeqlock<T> &block, const T &data, SideResults &results)
+{
+	uint64_t before = nanos();
+	seqlockWrite(block, data);
+	uint64_t elapsed = nanos() - before;
+	++results.writes;
+	results.writeNanos += elapsed;
+	results.maxWriteNanos = std::max(results.maxWriteNanos, elapsed);
+}
+
+// Stand-in autonomy process: echo every new state back as a command until told to stop
+static int autonomyProcess(TestShared *shared, unsigned roundTrips)
+{
+	SideResults &results = shared->autonomySide;
+	uint64_t lastStamp = 0;
+	for(unsigned i = 0; i < roundTrips + 1; ++i)
+	{
+		AutonomyStateData state;
+		if(!poll(shared->mailbox.state, state, results, [lastStamp](const AutonomyStateData &s) { return s.timestampMicros != lastStamp; }))
+			return 1;
+		uint64_t received = nanos();
+		if(state.activeCommands & stopFlag) return 0;
+		if(i < roundTrips) shared->oneWayNanos[i] = (uint32_t)std::min<uint64_t>(received - state.timestampMicros, UINT32_MAX);
+		lastStamp = state.timestampMicros;
+
+		AutonomyCommandData command;
+		fill(command, state.timestampMicros);
+		timedWrite(shared->mailbox.command, command, results);
+	}
+	return 0;
+}
+
+static double percentile(std::vector<uint32_t> &values, double p)
+{
+	if(values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return values[(size_t)(p * (values.size() - 1))] / 1000.0;
+}
+
+static void reportSide(const char *name, const SideResults &results)
+{
+	std::cout << "  " << name << ": " << results.reads << " reads, mean " << (results.reads ? (double)results.readNanos / results.reads : 0)
+			<< " ns max " << results.maxReadNanos << " ns, " << results.failedReads << " retries exhausted, " << results.tornReads << " torn; "
+			<< results.writes << " writes, mean " << (results.writes ? (double)results.writeNanos / results.writes : 0) << " ns max "
+			<< results.maxWriteNanos << " ns" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned roundTrips = (argc > 1) ? (unsigned)atoi(argv[1]) : 100000;
+	if(roundTrips == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [round trips]" << std::endl;
+		return 2;
+	}
+
+	size_t size = sizeof(TestShared) + roundTrips * sizeof(uint32_t);
+	int fd = shm_open(testSharedName, O_CREAT | O_RDWR, 0600);
+	if(fd < 0 || ftruncate(fd, size) != 0)
+	{
+		std::cerr << "AutonomyLatency: could not create shared memory" << std::endl;
+		return 1;
+	}
+	TestShared *shared = (TestShared *)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	shm_unlink(testSharedName); // The mapping outlives the name, and nothing is left behind in /dev/shm
+	if(shared == MAP_FAILED)
+	{
+		std::cerr << "AutonomyLatency: could not map shared memory" << std::endl;
+		return 1;
+	}
+	memset((void *)shared, 0, size);
+
+	pid_t child = fork();
+	if(child == 0)
+		_exit(autonomyProcess(shared, roundTrips));
+
+	// Robot side: publish state, wait for the matching command
+	SideResults results;
+	memset(&results, 0, sizeof(results));
+	std::vector<uint32_t> roundTripNanos;
+	roundTripNanos.reserve(roundTrips);
+	bool echoed = true;
+	for(unsigned i = 0; i < roundTrips && echoed; ++i)
+	{
+		AutonomyStateData state;
+		uint64_t sent = nanos();
+		fill(state, sent);
+		state.activeCommands = 0;
+		timedWrite(shared->mailbox.state, state, results);
+
+		AutonomyCommandData command;
+		echoed = poll(shared->mailbox.command, command, results, [sent](const AutonomyCommandData &c) { return c.timestampMicros == sent; });
+		if(echoed) roundTripNanos.push_back((uint32_t)std::min<uint64_t>(nanos() - sent, UINT32_MAX));
+	}
+
+	AutonomyStateData stop;
+	fill(stop, nanos());
+	stop.activeCommands = stopFlag;
+	seqlockWrite(shared->mailbox.state, stop);
+	int status = 0;
+	waitpid(child, &status, 0);
+
+	std::vector<uint32_t> oneWayNanos(shared->oneWayNanos, shared->oneWayNanos + roundTripNanos.size());
+	std::cout << "Autonomy mailbox: " << roundTripNanos.size() << " of " << roundTrips << " round trips between two processes" << std::endl;
+	std::cout << "  one way    p50 " << percentile(oneWayNanos, 0.5) << " us p99 " << percentile(oneWayNanos, 0.99)
+			<< " us max " << percentile(oneWayNanos, 1.0) << " us" << std::endl;
+	std::cout << "  round trip p50 " << percentile(roundTripNanos, 0.5) << " us p99 " << percentile(roundTripNanos, 0.99)
+			<< " us max " << percentile(roundTripNanos, 1.0) << " us" << std::endl;
+	reportSide("robot", results);
+	reportSide("autonomy", shared->autonomySide);
+
+	bool pass = echoed && WIFEXITED(status) && (WEXITSTATUS(status) == 0)
+			&& (results.tornReads == 0) && (shared->autonomySide.tornReads == 0);
+	munmap(shared, size);
+	std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass ? 0 : 1;
+}
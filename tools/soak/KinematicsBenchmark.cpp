@@ -0,0 +1,109 @@
+/*
+ * Host microbenchmark of the manipulator kinematics (src/Kinematics.cpp).
+ * Times batches of forward and inverse solves over random poses, some outside the joint limits, and
+ * reports nanoseconds per solve. Also checks that every inverse solution is within the joint limits and that
+ * forward kinematics of it reproduces the (possibly pulled back) pose.
+ * The exit status is 1 if a check fails.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++1y -O2 -Itools/soak -Isrc -o KinematicsBenchmark tools/soak/KinematicsBenchmark.cpp src/Kinematics.cpp
+ * Usage: KinematicsBenchmark [solves]
+ */
+
+#include <Kinematics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+SimWorld sim;
+
+// Poses are timed in batches so the clock resolution does not matter
+static const unsigned batchSize = 1000;
+
+// Largest FK(IK(pose)) mismatch accepted, in centimeters or degrees
+static const float tolerance = 1e-3;
+
+int main(int argc, char **argv)
+{
+	unsigned solves = (argc > 1) ? (unsigned)atoi(argv[1]) : 1000000;
+	if(solves < batchSize)
+	{
+		std::cerr << "Usage: " << argv[0] << " [solves, at least " << batchSize << "]" << std::endl;
+		return 2;
+	}
+	memset(&sim, 0, sizeof(sim));
+
+	// Poses from joints spanning 120% of each range, so about half of them hit a limit
+	std::mt19937 random(1);
+	std::vector<float> poses(batchSize * NUM_CARTESIAN_AXES);
+	for(unsigned n = 0; n < batchSize; ++n)
+	{
+		float joints[NUM_MANIPULATOR_JOINTS];
+		for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		{
+			float margin = 0.1 * (manipulatorJointLimits[i][1] - manipulatorJointLimits[i][0]);
+			joints[i] = std::uniform_real_distribution<float>(manipulatorJointLimits[i][0] - margin, manipulatorJointLimits[i][1] + margin)(random);
+		}
+		forwardKinematics(joints, &poses[n * NUM_CARTESIAN_AXES]);
+	}
+
+	// Accuracy and limits
+	unsigned reachable = 0, failures = 0;
+	for(unsigned n = 0; n < batchSize; ++n)
+	{
+		float pose[NUM_CARTESIAN_AXES], joints[NUM_MANIPULATOR_JOINTS] = {0}, check[NUM_CARTESIAN_AXES];
+		memcpy(pose, &poses[n * NUM_CARTESIAN_AXES], sizeof(pose));
+		if(inverseKinematics(pose, joints)) ++reachable;
+		forwardKinematics(joints, check);
+		bool ok = true;
+		for(unsigned i = ElevatorJoint; i <= RollJoint; ++i)
+			ok = ok && (joints[i] >= manipulatorJointLimits[i][0]) && (joints[i] <= manipulatorJointLimits[i][1]);
+		for(unsigned i = 0; i < NUM_CARTESIAN_AXES; ++i)
+			ok = ok && (std::fabs(check[i] - pose[i]) <= tolerance);
+		if(!ok) ++failures;
+	}
+
+	// Timing; the results are accumulated so the solves cannot be optimised away
+	std::vector<double> inverseNanos, forwardNanos;
+	volatile float sink = 0;
+	for(unsigned batch = 0; batch < solves / batchSize; ++batch)
+	{
+		float pose[NUM_CARTESIAN_AXES], joints[NUM_MANIPULATOR_JOINTS] = {0};
+		float sum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(unsigned n = 0; n < batchSize; ++n)
+		{
+			memcpy(pose, &poses[n * NUM_CARTESIAN_AXES], sizeof(pose));
+			inverseKinematics(pose, joints);
+			sum += joints[ElevatorJoint];
+		}
+		auto middle = std::chrono::steady_clock::now();
+		for(unsigned n = 0; n < batchSize; ++n)
+		{
+			joints[PitchJoint] = poses[n * NUM_CARTESIAN_AXES + CartesianPitch];
+			forwardKinematics(joints, pose);
+			sum += pose[CartesianHeight];
+		}
+		auto end = std::chrono::steady_clock::now();
+		sink = sink + sum;
+		inverseNanos.push_back(std::chrono::duration<double, std::nano>(middle - start).count() / batchSize);
+		forwardNanos.push_back(std::chrono::duration<double, std::nano>(end - middle).count() / batchSize);
+	}
+
+	auto report = [](const char *name, std::vector<double> &nanos) {
+		std::sort(nanos.begin(), nanos.end());
+		std::cout << "  " << name << " median " << nanos[nanos.size() / 2] << " ns, best " << nanos.front()
+				<< " ns, worst batch " << nanos.back() << " ns per solve" << std::endl;
+	};
+	std::cout << "Kinematics: " << (solves / batchSize) * batchSize << " solves in batches of " << batchSize << ", "
+			<< reachable << " of " << batchSize << " poses reachable" << std::endl;
+	report("inverse", inverseNanos);
+	report("forward", forwardNanos);
+	std::cout << "  " << failures << " solutions outside the limits or not matching their pose" << std::endl;
+	std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ * Host test of the real-time mode (src/RealTime.cpp).
+ * Runs a control loop shaped like Robot's (begin, due loops, account, update) on one core shared with
+ * spinning load threads, first with normal scheduling and then after RealTime::enable(), and compares how late
+ * the loop runs against its period. Lateness is measured on the host monotonic clock, which also drives the
+ * simulated FPGA timestamp (see WPILib.h in this directory) so RealTime sees real time.
+ *
+ * SCHED_FIFO needs root or CAP_SYS_NICE; without it the real-time phase is skipped and the test passes.
+ * The exit status is 1 if the real-time phase has a worse p99 lateness than the normal phase.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++1y -O2 -pthread -Itools/soak -Isrc -o RealTimeJitter tools/soak/RealTimeJitter.cpp src/RealTime.cpp -lrt
+ * Usage: RealTimeJitter [seconds per phase] [load threads]
+ */
+
+#include <Constants.h>
+#include <RealTime.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+SimWorld sim;
+
+// Simulated control work per loop run, in microseconds
+static const uint32_t workMicros = 200;
+
+static uint64_t monotonicNanos()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct PhaseResult
+{
+	uint64_t runs;
+	double p50, p99, max; // Lateness in microseconds
+};
+
+/**
+ * Runs the control loop for a while and measures how late each run of the Safety and Drive loops starts.
+ * @param realTime accounting instance, enabled or not
+ * @param seconds how long to run
+ * @return lateness statistics
+ */
+static PhaseResult runPhase(RealTime &realTime, double seconds)
+{
+	const uint32_t periods[2] = {safetyPeriod, drivePeriod};
+	uint64_t start = monotonicNanos();
+	uint64_t lastRun[2] = {start, start};
+	std::vector<uint32_t> lateness;
+
+	realTime.reset();
+	while(monotonicNanos() - start < (uint64_t)(seconds * 1e9))
+	{
+		uint64_t now = monotonicNanos();
+		sim.timeMicros = (now - start) / 1000;
+		realTime.begin();
+		for(unsigned i = 0; i < 2; ++i)
+		{
+			now = monotonicNanos();
+			if(now - lastRun[i] < (uint64_t)periods[i] * 1000) continue;
+			lateness.push_back((uint32_t)((now - lastRun[i]) / 1000 - periods[i]));
+			lastRun[i] = now;
+			while(monotonicNanos() - now < workMicros * 1000) {}
+			realTime.account(i == 0 ? SafetyLoop : DriveLoop);
+		}
+		realTime.update();
+	}
+
+	std::sort(lateness.begin(), lateness.end());
+	auto percentile = [&lateness](double p) { return lateness.empty() ? 0.0 : (double)lateness[(size_t)(p * (lateness.size() - 1))]; };
+	return {lateness.size(), percentile(0.5), percentile(0.99), percentile(1.0)};
+}
+
+static void report(const char *name, const PhaseResult &result)
+{
+	std::cout << "  " << std::setw(8) << std::left << name << std::right << result.runs << " runs, lateness p50 " << result.p50
+			<< " us p99 " << result.p99 << " us max " << result.max << " us" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = (argc > 1) ? atof(argv[1]) : 5;
+	unsigned loadThreads = (argc > 2) ? (unsigned)atoi(argv[2]) : 2;
+	if(seconds <= 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [seconds per phase] [load threads]" << std::endl;
+		return 2;
+	}
+	memset(&sim, 0, sizeof(sim));
+
+	// Put the control thread and the load on the core enable() pins to, or the last core if there are fewer
+	cpu_set_t core;
+	CPU_ZERO(&core);
+	CPU_SET(std::min(1u, std::thread::hardware_concurrency() - 1), &core);
+	pthread_setaffinity_np(pthread_self(), sizeof(core), &core);
+
+	std::atomic<bool> stopLoad(false);
+	std::vector<std::thread> load;
+	for(unsigned i = 0; i < loadThreads; ++i)
+	{
+		load.emplace_back([&stopLoad] { volatile uint64_t spin = 0; while(!stopLoad.load(std::memory_order_relaxed)) ++spin; });
+		pthread_setaffinity_np(load.back().native_handle(), sizeof(core), &core);
+	}
+
+	// RTIME packets and RealTime messages are not needed here
+	std::ostringstream discarded;
+	std::streambuf *realStdout = std::cout.rdbuf(discarded.rdbuf());
+
+	RealTime realTime;
+	PhaseResult normal = runPhase(realTime, seconds);
+
+	struct sched_param param;
+	int policy = SCHED_OTHER;
+	realTime.enable();
+	pthread_getschedparam(pthread_self(), &policy, &param);
+	bool fifo = (policy == SCHED_FIFO);
+	PhaseResult fifoResult = {0, 0, 0, 0};
+	if(fifo)
+		fifoResult = runPhase(realTime, seconds);
+
+	std::cout.rdbuf(realStdout);
+	stopLoad = true;
+	for(std::thread &thread : load)
+		thread.join();
+
+	std::cout << std::fixed << std::setprecision(0);
+	std::cout << "Loop lateness with " << loadThreads << " spinning load threads on the control core, " << seconds << " s per phase:" << std::endl;
+	report("normal", normal);
+	if(!fifo)
+	{
+		std::cout << "  SCHED_FIFO unavailable, real-time phase skipped" << std::endl << "SKIP" << std::endl;
+		return 0;
+	}
+	report("FIFO", fifoResult);
+
+	bool pass = fifoResult.p99 <= normal.p99;
+	std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,763 @@
+/*
+ * Host soak and stress harness for the control loops.
+ * Runs Safety, Drive and Manipulator against simulated devices (see WPILib.h in this directory) for hours of
+ * simulated time while a scripted operator drives them and adverse conditions are injected:
+ * slow and failing PDP reads, stalled stdout, CPU hogs on sibling threads, FPGA timestamp jumps,
+ * encoder and potentiometer dropouts, and motor overcurrents.
+ *
+ * Invariants checked continuously:
+ *  - the relay trips within relayTripBound of an injected overcurrent (unless PDP reads were failing)
+ *  - no motor output while the corresponding enable button is released (after one loop period)
+ *  - loop periods stay within the tolerance of their nominal period; the wall clock time spent in each
+ *    call into the robot code is charged to simulated time, so host preemption (CPU hogs) can make loops late
+ * A timing and latency report is printed at the end; the exit status is 1 if any invariant was violated.
+ *
+ * With --tracking, the soak is replaced by a feedforward comparison without faults: the manipulator follows
+ * a fixed sequence of joint steps without feedforward, a calibration sweep is run and identified, and the
+ * same steps are followed again. Tracking error and joint current are reported for both runs.
+ * Files the robot code writes (black box dumps, feedforward calibration) go to a temporary directory, and the
+ * autonomy shared memory is unlinked, at exit.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++1y -O2 -pthread -Itools/soak -Isrc -o SoakHarness tools/soak/SoakHarness.cpp \
+ *       src/Safety.cpp src/Drive.cpp src/Manipulator.cpp src/MotorOutput.cpp src/JointSensors.cpp \
+ *       src/Kinematics.cpp src/JointFeedforward.cpp src/BlackBox.cpp src/AutonomyInterface.cpp -lrt
+ * Usage: SoakHarness [--hours H] [--seed S] [--hogs N] [--tolerance-ms T] [--<fault>-rate R] ... [--tracking]
+ *   (run with --help for the full list)
+ */
+
+#include <Constants.h>
+#include <BlackBox.h>
+#include <Safety.h>
+#include <MotorOutput.h>
+#include <AutonomyInterface.h>
+#include <Drive.h>
+#include <Manipulator.h>
+#include <RealTime.h>
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+SimWorld sim;
+
+// Simulation step in microseconds
+static const uint32_t tickMicros = 1000;
+
+// Relay must trip within this long of an injected overcurrent, in microseconds
+static const uint64_t relayTripBound = 600 * 1000;
+
+// Plant model parameters
+static const double driveFreeSpeed = 2500; // Encoder counts per second at full power
+static const double driveTimeConstant = 0.1; // Seconds
+static const double jointFreeSpeed[NUM_MANIPULATOR_JOINTS] = {30, 30, 60, 60, 60}; // Degrees per second at full power
+static const double jointGravity[NUM_MANIPULATOR_JOINTS] = {0.15, 0, 0.1, 0, 0}; // Power needed to hold against gravity
+static const double overcurrentAmps = 40;
+
+// Feedforward comparison: joint steps held for trackingHold seconds, calibration sweep lasting trackingSweep seconds
+static const unsigned trackingSteps = 24;
+static const double trackingHold = 15;
+static const double trackingSweep = 120;
+
+struct SoakConfig
+{
+	double hours = 2;
+	unsigned seed = 1;
+	unsigned hogs = std::thread::hardware_concurrency();
+	double toleranceMillis = 15;
+
+	// Fault episodes per simulated minute, and their magnitudes
+	double pdpSlowRate = 0.5;
+	uint32_t pdpSlowMicros = 500;
+	double pdpFailRate = 0.2;
+	double stdoutStallRate = 0.5;
+	uint32_t stdoutStallMicros = 5000;
+	double jumpRate = 0.2;
+	uint32_t jumpMaxMicros = 200 * 1000;
+	double dropoutRate = 0.5;
+	double overcurrentRate = 1;
+
+	bool tracking = false;
+};
+
+/*
+ * Stream buffer standing in for stdout. Output is discarded; while a stall is injected, every line written by
+ * the control thread takes stallMicros of simulated time. Output from other threads (the BlackBox writer) is
+ * discarded without touching the simulation.
+ */
+class SimStreambuf : public std::streambuf
+{
+	public:
+		SimStreambuf() : stallMicros(0), lines(0), owner(std::this_thread::get_id()) {}
+		uint32_t stallMicros;
+		uint64_t lines;
+
+	protected:
+		int overflow(int c) override
+		{
+			if(c == '\n' && std::this_thread::get_id() == owner)
+			{
+				sim.timeMicros += stallMicros;
+				++lines;
+			}
+			return c;
+		}
+		std::streamsize xsputn(const char *s, std::streamsize n) override
+		{
+			for(std::streamsize i = 0; i < n; ++i)
+				overflow(s[i]);
+			return n;
+		}
+
+	private:
+		std::thread::id owner;
+};
+
+// A fault that is active for random episodes, started at a given rate
+struct FaultEpisode
+{
+	const char *name;
+	double ratePerMinute;
+	uint64_t endMicros;
+	uint64_t episodes;
+	uint64_t activeMicros;
+	bool active(uint64_t now) const { return now < endMicros; }
+};
+
+struct LoopTiming
+{
+	const char *name;
+	uint32_t periodMicros;
+	uint64_t lastRunMicros;
+	bool jumpSinceLastRun;
+	uint64_t runs;
+	uint64_t lateRuns;
+	uint64_t jumpAffectedRuns;
+	uint64_t maxIntervalMicros;
+	double intervalSum;
+	uint64_t intervals;
+	std::vector<uint32_t> executionNanos; // Wall clock time spent in update()
+};
+
+struct OvercurrentEvent
+{
+	unsigned pdpChannel;
+	uint64_t startMicros;
+	uint64_t endMicros;
+	bool tripped;
+	bool masked;
+	bool checked;
+};
+
+class SoakHarness
+{
+	public:
+		SoakHarness(const SoakConfig &config);
+		~SoakHarness();
+		int run();
+		int tracking();
+
+	private:
+		SoakConfig config;
+		std::mt19937 random;
+		SimStreambuf stdoutBuffer;
+		char dataDirectory[32]; // Stands in for robotDataDirectory
+
+		FaultEpisode pdpSlow, pdpFail, stdoutStall, dropout;
+		uint64_t jumps;
+		LoopTiming timing[NUM_CONTROL_LOOPS];
+
+		std::vector<OvercurrentEvent> overcurrents;
+		uint64_t overcurrentsTripped, overcurrentsMasked, overcurrentViolations;
+		uint64_t maxTripLatency;
+		uint64_t relayTrips;
+		uint64_t unprovokedTrips; // Trips with no overcurrent injected
+		bool lastRelay;
+
+		uint64_t driveReleaseMicros, manipulatorReleaseMicros;
+		bool driveViolationReported, manipulatorViolationReported;
+		uint64_t driveEnableViolations, manipulatorEnableViolations;
+
+		uint64_t nextOperatorChange;
+		double encoderPosition[NUM_DRIVE_MOTORS];
+		double driveSpeed[NUM_DRIVE_MOTORS];
+		double jointAngle[NUM_MANIPULATOR_JOINTS];
+		unsigned droppedEncoder, droppedAnalog;
+		uint64_t lastPlantMicros;
+		uint32_t writesIssued, writesSuppressed; // MotorOutput totals at the end of the run
+		uint64_t chargedNanos; // Wall clock time not yet charged to simulated time
+
+		double uniform(double low, double high) { return std::uniform_real_distribution<double>(low, high)(random); }
+		bool chance(double probability) { return uniform(0, 1) < probability; }
+		bool startEpisode(FaultEpisode &fault, uint64_t now);
+		void stepFaults(uint64_t now);
+		void stepOperator(uint64_t now);
+		void stepPlant(uint64_t now);
+		void checkInvariants(uint64_t now);
+		uint32_t charge(std::chrono::steady_clock::time_point start);
+		void recordRun(ControlLoops loop, uint64_t now, uint32_t executionNanos);
+		bool report();
+};
+
+SoakHarness::SoakHarness(const SoakConfig &config) : config(config), random(config.seed)
+{
+	memset(&sim, 0, sizeof(sim));
+	sim.dio[relayPin] = true;
+	strcpy(dataDirectory, "/tmp/soak_XXXXXX");
+	if(mkdtemp(dataDirectory) == nullptr)
+		strcpy(dataDirectory, "/tmp");
+
+	pdpSlow = {"slow PDP reads", config.pdpSlowRate, 0, 0, 0};
+	pdpFail = {"failing PDP reads", config.pdpFailRate, 0, 0, 0};
+	stdoutStall = {"stalled stdout", config.stdoutStallRate, 0, 0, 0};
+	dropout = {"sensor dropouts", config.dropoutRate, 0, 0, 0};
+	jumps = 0;
+
+	const char *names[NUM_CONTROL_LOOPS] = {"Safety", "Drive", "Manipulator"};
+	const uint32_t periods[NUM_CONTROL_LOOPS] = {safetyPeriod, drivePeriod, manipulatorPeriod};
+	for(unsigned i = 0; i < NUM_CONTROL_LOOPS; ++i)
+	{
+		timing[i] = LoopTiming();
+		timing[i].name = names[i];
+		timing[i].periodMicros = periods[i];
+	}
+
+	overcurrentsTripped = overcurrentsMasked = overcurrentViolations = 0;
+	maxTripLatency = 0;
+	relayTrips = 0;
+	unprovokedTrips = 0;
+	lastRelay = true;
+	driveReleaseMicros = manipulatorReleaseMicros = 0;
+	driveViolationReported = manipulatorViolationReported = false;
+	driveEnableViolations = manipulatorEnableViolations = 0;
+	nextOperatorChange = 0;
+	droppedEncoder = droppedAnalog = 0;
+	lastPlantMicros = 0;
+	writesIssued = writesSuppressed = 0;
+	chargedNanos = 0;
+
+	// Start the manipulator joints in the middle of their ranges
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+		encoderPosition[i] = driveSpeed[i] = 0;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		jointAngle[i] = (manipulatorJointLimits[i][0] + manipulatorJointLimits[i][1]) / 2;
+	stepPlant(0);
+}
+
+SoakHarness::~SoakHarness()
+{
+	shm_unlink(autonomySharedName);
+	if(strcmp(dataDirectory, "/tmp") == 0) return;
+	DIR *directory = opendir(dataDirectory);
+	if(directory != nullptr)
+	{
+		while(struct dirent *entry = readdir(directory))
+			if(entry->d_name[0] != '.')
+				unlink((std::string(dataDirectory) + "/" + entry->d_name).c_str());
+		closedir(directory);
+	}
+	rmdir(dataDirectory);
+}
+
+bool SoakHarness::startEpisode(FaultEpisode &fault, uint64_t now)
+{
+	if(fault.active(now) || !chance(fault.ratePerMinute * tickMicros / 60e6)) return false;
+	uint64_t duration = (uint64_t)uniform(0.5e6, 5e6);
+	fault.endMicros = now + duration;
+	fault.activeMicros += duration;
+	++fault.episodes;
+	return true;
+}
+
+void SoakHarness::stepFaults(uint64_t now)
+{
+	startEpisode(pdpSlow, now);
+	sim.pdpReadDelayMicros = pdpSlow.active(now) ? config.pdpSlowMicros : 0;
+
+	startEpisode(pdpFail, now);
+	sim.pdpFailing = pdpFail.active(now);
+
+	startEpisode(stdoutStall, now);
+	stdoutBuffer.stallMicros = stdoutStall.active(now) ? config.stdoutStallMicros : 0;
+
+	if(!dropout.active(now))
+	{
+		sim.analogDropout[manipulatorPotentiometerPins[droppedAnalog]] = false;
+		if(startEpisode(dropout, now))
+		{
+			// Either an encoder freezes or a potentiometer reads zero
+			droppedEncoder = random() % (2 * NUM_DRIVE_MOTORS);
+			droppedAnalog = random() % NUM_MANIPULATOR_JOINTS;
+			if(droppedEncoder >= NUM_DRIVE_MOTORS)
+				sim.analogDropout[manipulatorPotentiometerPins[droppedAnalog]] = true;
+		}
+	}
+
+	if(chance(config.jumpRate * tickMicros / 60e6))
+	{
+		sim.fpgaOffsetMicros += (int64_t)uniform(1000, config.jumpMaxMicros);
+		for(unsigned i = 0; i < NUM_CONTROL_LOOPS; ++i)
+			timing[i].jumpSinceLastRun = true;
+		++jumps;
+	}
+
+	if(chance(config.overcurrentRate * tickMicros / 60e6))
+	{
+		unsigned motor = random() % (NUM_DRIVE_MOTORS + NUM_MANIPULATOR_JOINTS);
+		OvercurrentEvent event;
+		event.pdpChannel = (motor < NUM_DRIVE_MOTORS) ? drivePowerChannels[motor] : manipulatorPowerChannels[motor - NUM_DRIVE_MOTORS];
+		event.startMicros = now;
+		event.endMicros = now + (uint64_t)uniform(1e6, 3e6);
+		event.tripped = event.masked = event.checked = false;
+		overcurrents.push_back(event);
+	}
+}
+
+void SoakHarness::stepOperator(uint64_t now)
+{
+	if(now < nextOperatorChange) return;
+	nextOperatorChange = now + (uint64_t)uniform(2e6, 20e6);
+
+	for(unsigned port = 0; port < SIM_JOYSTICKS; ++port)
+		for(unsigned axis = 0; axis < SIM_JOYSTICK_AXES; ++axis)
+			sim.axes[port][axis] = uniform(-1, 1);
+
+	sim.buttons[0][DriveEnable] = chance(0.8);
+	sim.buttons[0][DriveRun] = chance(0.7);
+	sim.buttons[0][DriveOverride] = chance(0.1);
+	sim.buttons[1][ManipulatorEnable] = chance(0.8);
+	sim.buttons[1][ManipulatorRun] = chance(0.7);
+	sim.buttons[1][ManipulatorControllable] = chance(0.6);
+	sim.buttons[1][ManipulatorCartesian] = chance(0.2);
+}
+
+void SoakHarness::stepPlant(uint64_t now)
+{
+	double dt = (now - lastPlantMicros) / 1e6;
+	lastPlantMicros = now;
+	bool powered = sim.dio[relayPin];
+
+	for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+	{
+		double power = powered ? sim.pwm[driveMotorPins[i]] : 0;
+		driveSpeed[i] += (power * driveFreeSpeed - driveSpeed[i]) * std::min(1.0, dt / driveTimeConstant);
+		encoderPosition[i] += driveSpeed[i] * dt;
+		if(!(dropout.active(now) && droppedEncoder == i))
+			sim.encoder[driveEncoderPins[i][0]] = (int32_t)encoderPosition[i];
+		sim.pdpCurrent[drivePowerChannels[i]] = powered ? 1 + 20 * std::fabs(power - driveSpeed[i] / driveFreeSpeed) : 0;
+	}
+
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		double power = powered ? sim.pwm[manipulatorMotorPins[i]] : 0;
+		double gravity = (i == PitchJoint) ? jointGravity[i] * std::cos(jointAngle[i] * M_PI / 180) : jointGravity[i];
+		jointAngle[i] += (power - gravity) * jointFreeSpeed[i] * dt;
+		jointAngle[i] = constrain(jointAngle[i], manipulatorJointLimits[i][0] - 5, manipulatorJointLimits[i][1] + 5);
+		sim.analogVoltage[manipulatorPotentiometerPins[i]] = 5 * (jointAngle[i] / manipulatorPotentiometerScale[i] + manipulatorPotentiometerOffset[i]);
+		sim.pdpCurrent[manipulatorPowerChannels[i]] = powered ? 1 + 8 * std::fabs(power) : 0;
+	}
+
+	// Injected overcurrents last until the relay cuts power
+	for(const OvercurrentEvent &event : overcurrents)
+		if(powered && now >= event.startMicros && now < event.endMicros)
+			sim.pdpCurrent[event.pdpChannel] = overcurrentAmps;
+}
+
+void SoakHarness::checkInvariants(uint64_t now)
+{
+	bool relay = sim.dio[relayPin];
+	if(lastRelay && !relay)
+	{
+		++relayTrips;
+		bool provoked = false;
+		for(const OvercurrentEvent &event : overcurrents)
+			provoked = provoked || (now >= event.startMicros && now < event.endMicros + relayTripBound);
+		if(!provoked) ++unprovokedTrips;
+	}
+	lastRelay = relay;
+
+	for(OvercurrentEvent &event : overcurrents)
+	{
+		if(event.checked) continue;
+		if(pdpFail.active(now)) event.masked = true;
+		if(!relay && !event.tripped)
+		{
+			event.tripped = true;
+			maxTripLatency = std::max(maxTripLatency, now - event.startMicros);
+		}
+		if(event.tripped || now >= event.startMicros + relayTripBound)
+		{
+			event.checked = true;
+			if(event.tripped) ++overcurrentsTripped;
+			else if(event.masked) ++overcurrentsMasked;
+			else ++overcurrentViolations;
+		}
+	}
+	overcurrents.erase(std::remove_if(overcurrents.begin(), overcurrents.end(),
+			[now](const OvercurrentEvent &event) { return event.checked && now >= event.endMicros; }), overcurrents.end());
+
+	// Outputs may lag a button release by one loop period plus the timing tolerance
+	uint64_t tolerance = (uint64_t)(config.toleranceMillis * 1000);
+	if(sim.buttons[0][DriveEnable])
+	{
+		driveReleaseMicros = now;
+		driveViolationReported = false;
+	}
+	else if(!driveViolationReported && now - driveReleaseMicros > drivePeriod + tolerance)
+	{
+		for(unsigned i = 0; i < NUM_DRIVE_MOTORS; ++i)
+		{
+			if(sim.pwm[driveMotorPins[i]] != 0)
+			{
+				++driveEnableViolations;
+				driveViolationReported = true;
+				break;
+			}
+		}
+	}
+	if(sim.buttons[1][ManipulatorEnable])
+	{
+		manipulatorReleaseMicros = now;
+		manipulatorViolationReported = false;
+	}
+	else if(!manipulatorViolationReported && now - manipulatorReleaseMicros > manipulatorPeriod + tolerance)
+	{
+		for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		{
+			if(sim.pwm[manipulatorMotorPins[i]] != 0)
+			{
+				++manipulatorEnableViolations;
+				manipulatorViolationReported = true;
+				break;
+			}
+		}
+	}
+}
+
+uint32_t SoakHarness::charge(std::chrono::steady_clock::time_point start)
+{
+	uint32_t nanos = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	chargedNanos += nanos;
+	sim.timeMicros += chargedNanos / 1000;
+	chargedNanos %= 1000;
+	return nanos;
+}
+
+void SoakHarness::recordRun(ControlLoops loop, uint64_t now, uint32_t executionNanos)
+{
+	LoopTiming &t = timing[loop];
+	t.executionNanos.push_back(executionNanos);
+
+	if(t.runs > 0)
+	{
+		uint64_t interval = now - t.lastRunMicros;
+		if(t.jumpSinceLastRun)
+			++t.jumpAffectedRuns;
+		else
+		{
+			t.maxIntervalMicros = std::max(t.maxIntervalMicros, interval);
+			t.intervalSum += interval;
+			++t.intervals;
+			if(interval > t.periodMicros + config.toleranceMillis * 1000) ++t.lateRuns;
+		}
+	}
+	t.jumpSinceLastRun = false;
+	t.lastRunMicros = now;
+	++t.runs;
+}
+
+int SoakHarness::run()
+{
+	std::streambuf *realStdout = std::cout.rdbuf(&stdoutBuffer);
+
+	std::atomic<bool> stopHogs(false);
+	std::vector<std::thread> hogs;
+	for(unsigned i = 0; i < config.hogs; ++i)
+		hogs.emplace_back([&stopHogs] { volatile uint64_t spin = 0; while(!stopHogs.load(std::memory_order_relaxed)) ++spin; });
+
+	{
+		// Same construction and loop order as Robot
+		Joystick joystickDrive(0), joystickManipulator(1);
+		PowerDistributionPanel pdp;
+		BlackBox blackBox(dataDirectory);
+		Safety safety(&joystickDrive, &joystickManipulator, &pdp, &blackBox);
+		MotorOutput output;
+		AutonomyInterface autonomy(&safety);
+		Drive drive(&joystickDrive, &safety, &output, &blackBox, &autonomy);
+		Manipulator manipulator(&joystickManipulator, &safety, &output, &blackBox, &autonomy, dataDirectory);
+
+		safety.reset();
+		output.reset();
+		autonomy.reset();
+		drive.reset();
+		manipulator.reset();
+
+		uint64_t endMicros = (uint64_t)(config.hours * 3600e6);
+		while(sim.timeMicros < endMicros)
+		{
+			sim.timeMicros += tickMicros;
+			uint64_t now = sim.timeMicros;
+			stepFaults(now);
+			stepOperator(now);
+			stepPlant(now);
+
+			// Loop timings use the time each loop started, as the loops and their execution time advance simulated time
+			uint64_t loopStart = sim.timeMicros;
+			auto start = std::chrono::steady_clock::now();
+			bool ran = safety.update();
+			uint32_t nanos = charge(start);
+			if(ran) recordRun(SafetyLoop, loopStart, nanos);
+			start = std::chrono::steady_clock::now();
+			autonomy.update();
+			charge(start);
+			loopStart = sim.timeMicros;
+			start = std::chrono::steady_clock::now();
+			ran = drive.update();
+			nanos = charge(start);
+			if(ran) recordRun(DriveLoop, loopStart, nanos);
+			loopStart = sim.timeMicros;
+			start = std::chrono::steady_clock::now();
+			ran = manipulator.update();
+			nanos = charge(start);
+			if(ran) recordRun(ManipulatorLoop, loopStart, nanos);
+			start = std::chrono::steady_clock::now();
+			output.update();
+			charge(start);
+
+			checkInvariants(sim.timeMicros);
+		}
+		writesIssued = output.getWritesIssued();
+		writesSuppressed = output.getWritesSuppressed();
+	}
+
+	stopHogs = true;
+	for(std::thread &hog : hogs)
+		hog.join();
+	std::cout.rdbuf(realStdout);
+
+	return report() ? 0 : 1;
+}
+
+int SoakHarness::tracking()
+{
+	std::streambuf *realStdout = std::cout.rdbuf(&stdoutBuffer);
+
+	struct TrackingResult
+	{
+		double squaredError[NUM_MANIPULATOR_JOINTS]; // Whole run, after the first step
+		double steadyError[NUM_MANIPULATOR_JOINTS]; // Absolute error over the last second of each step
+		double current; // Sum of manipulator joint currents
+		uint64_t samples, steadySamples;
+	};
+	TrackingResult results[2];
+	memset(results, 0, sizeof(results));
+	bool identified = false;
+
+	{
+		Joystick joystickDrive(0), joystickManipulator(1);
+		PowerDistributionPanel pdp;
+		BlackBox blackBox(dataDirectory);
+		Safety safety(&joystickDrive, &joystickManipulator, &pdp, &blackBox);
+		MotorOutput output;
+		AutonomyInterface autonomy(&safety);
+		Drive drive(&joystickDrive, &safety, &output, &blackBox, &autonomy);
+		Manipulator manipulator(&joystickManipulator, &safety, &output, &blackBox, &autonomy, dataDirectory);
+
+		safety.reset();
+		output.reset();
+		autonomy.reset();
+		drive.reset();
+		manipulator.reset();
+
+		// Operator holds the manipulator enabled with the highest current limit, and sets joint positions directly
+		sim.axes[1][CurrentLimit] = 1;
+		sim.buttons[1][ManipulatorEnable] = true;
+		sim.buttons[1][ManipulatorRun] = true;
+		sim.buttons[1][ManipulatorControllable] = true;
+		auto command = [](unsigned joint, double angle) {
+			sim.axes[1][ElevatorPosition + joint] = map(angle, manipulatorJointLimits[joint][0], manipulatorJointLimits[joint][1], -1, 1);
+		};
+		auto step = [&]() {
+			sim.timeMicros += tickMicros;
+			stepPlant(sim.timeMicros);
+			safety.update();
+			autonomy.update();
+			drive.update();
+			manipulator.update();
+			output.update();
+		};
+
+		for(unsigned run = 0; run < 2; ++run)
+		{
+			// The same steps each run, within the middle 80% of each joint's range
+			std::mt19937 steps(config.seed);
+			TrackingResult &result = results[run];
+			for(unsigned n = 0; n < trackingSteps; ++n)
+			{
+				float target[NUM_MANIPULATOR_JOINTS];
+				for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+				{
+					double range = manipulatorJointLimits[i][1] - manipulatorJointLimits[i][0];
+					target[i] = manipulatorJointLimits[i][0] + range * std::uniform_real_distribution<double>(0.1, 0.9)(steps);
+					command(i, target[i]);
+				}
+
+				uint64_t end = sim.timeMicros + (uint64_t)(trackingHold * 1e6);
+				while(sim.timeMicros < end)
+				{
+					step();
+					if(n == 0) continue;
+					for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+					{
+						double error = target[i] - jointAngle[i];
+						result.squaredError[i] += error * error;
+						if(end - sim.timeMicros < 1000000) result.steadyError[i] += std::fabs(error);
+						result.current += sim.pdpCurrent[manipulatorPowerChannels[i]];
+					}
+					++result.samples;
+					if(end - sim.timeMicros < 1000000) ++result.steadySamples;
+				}
+			}
+
+			if(run > 0) break;
+
+			// Calibration sweep: each joint follows a slow sine through most of its range while ManipulatorCalibrate is held
+			sim.buttons[1][ManipulatorCalibrate] = true;
+			uint64_t start = sim.timeMicros;
+			while(sim.timeMicros - start < (uint64_t)(trackingSweep * 1e6))
+			{
+				double t = (sim.timeMicros - start) / 1e6;
+				for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+				{
+					double middle = (manipulatorJointLimits[i][0] + manipulatorJointLimits[i][1]) / 2;
+					double amplitude = 0.4 * (manipulatorJointLimits[i][1] - manipulatorJointLimits[i][0]);
+					command(i, middle + amplitude * std::sin(2 * M_PI * t / (40 + 5 * i)));
+				}
+				step();
+			}
+			sim.buttons[1][ManipulatorCalibrate] = false;
+			step();
+		}
+	}
+	std::cout.rdbuf(realStdout);
+
+	// Identified coefficients are saved by the robot code in the data directory
+	std::ifstream file(std::string(dataDirectory) + "/feedforward.txt");
+	float coefficients[NUM_MANIPULATOR_JOINTS][3];
+	identified = true;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+		identified = identified && (file >> coefficients[i][0] >> coefficients[i][1] >> coefficients[i][2]);
+
+	const char *names[NUM_MANIPULATOR_JOINTS] = {"Elevator", "Slider", "Pitch", "Roll", "Gripper"};
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Feedforward tracking: " << trackingSteps << " joint steps of " << trackingHold << " s, seed " << config.seed
+			<< ", calibration sweep " << trackingSweep << " s" << std::endl;
+	std::cout << "  (error in degrees; steady state is the mean absolute error over the last second of each step)" << std::endl;
+	for(unsigned i = 0; i < NUM_MANIPULATOR_JOINTS; ++i)
+	{
+		std::cout << "  " << std::setw(9) << std::left << names[i] << std::right << "gravity " << jointGravity[i]
+				<< "  rms error " << std::sqrt(results[0].squaredError[i] / results[0].samples) << " -> "
+				<< std::sqrt(results[1].squaredError[i] / results[1].samples) << ", steady state "
+				<< results[0].steadyError[i] / results[0].steadySamples << " -> " << results[1].steadyError[i] / results[1].steadySamples;
+		if(identified)
+			std::cout << "  (identified kGravity " << coefficients[i][0] << " kStatic " << coefficients[i][1]
+					<< " kViscous " << std::setprecision(4) << coefficients[i][2] << std::setprecision(2) << ")";
+		std::cout << std::endl;
+	}
+	std::cout << "  mean manipulator current " << results[0].current / results[0].samples << " A -> "
+			<< results[1].current / results[1].samples << " A" << std::endl;
+
+	std::cout << (identified ? "PASS" : "FAIL (feedforward not identified)") << std::endl;
+	return identified ? 0 : 1;
+}
+
+bool SoakHarness::report()
+{
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Soak: " << config.hours << " h simulated, seed " << config.seed << ", " << config.hogs << " CPU hog threads, "
+			<< stdoutBuffer.lines << " telemetry lines, " << sim.pwmWrites << " motor writes" << std::endl;
+	std::cout << "Motor output: " << writesIssued << " writes issued, " << writesSuppressed << " suppressed ("
+			<< 100.0 * writesSuppressed / std::max(writesIssued + writesSuppressed, (uint32_t)1) << "%)" << std::endl;
+
+	std::cout << "Faults:" << std::endl;
+	for(const FaultEpisode *fault : {&pdpSlow, &pdpFail, &stdoutStall, &dropout})
+		std::cout << "  " << std::setw(18) << std::left << fault->name << std::right << fault->episodes << " episodes, "
+				<< fault->activeMicros / 1e6 << " s" << std::endl;
+	std::cout << "  " << std::setw(18) << std::left << "timestamp jumps" << std::right << jumps << std::endl;
+
+	bool pass = true;
+	std::cout << "Loop timing (simulated period including charged execution, wall clock execution):" << std::endl;
+	for(LoopTiming &t : timing)
+	{
+		std::vector<uint32_t> &nanos = t.executionNanos;
+		std::sort(nanos.begin(), nanos.end());
+		auto percentile = [&nanos](double p) { return nanos.empty() ? 0 : nanos[(size_t)(p * (nanos.size() - 1))] / 1000.0; };
+		std::cout << "  " << std::setw(12) << std::left << t.name << std::right << t.runs << " runs, period mean "
+				<< (t.intervals ? t.intervalSum / t.intervals / 1000 : 0) << " ms max " << t.maxIntervalMicros / 1000.0 << " ms (nominal "
+				<< t.periodMicros / 1000.0 << "), " << t.lateRuns << " late, " << t.jumpAffectedRuns << " after jumps; execution p50 "
+				<< percentile(0.5) << " us p99 " << percentile(0.99) << " us max " << percentile(1.0) << " us" << std::endl;
+		if(t.lateRuns > 0) pass = false;
+	}
+
+	std::cout << "Invariants:" << std::endl;
+	std::cout << "  relay trips: " << relayTrips << " (" << unprovokedTrips << " unprovoked), overcurrents tripped " << overcurrentsTripped << " (max latency "
+			<< maxTripLatency / 1000.0 << " ms, bound " << relayTripBound / 1000.0 << " ms), masked by PDP failure "
+			<< overcurrentsMasked << ", missed " << overcurrentViolations << std::endl;
+	std::cout << "  output while disabled: drive " << driveEnableViolations << ", manipulator " << manipulatorEnableViolations << std::endl;
+	if(overcurrentViolations > 0 || driveEnableViolations > 0 || manipulatorEnableViolations > 0) pass = false;
+
+	std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+	return pass;
+}
+
+int main(int argc, char **argv)
+{
+	SoakConfig config;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		double value = (i + 1 < argc) ? atof(argv[i + 1]) : 0;
+		if(arg == "--hours") config.hours = value;
+		else if(arg == "--seed") config.seed = (unsigned)value;
+		else if(arg == "--hogs") config.hogs = (unsigned)value;
+		else if(arg == "--tolerance-ms") config.toleranceMillis = value;
+		else if(arg == "--pdp-slow-rate") config.pdpSlowRate = value;
+		else if(arg == "--pdp-slow-us") config.pdpSlowMicros = (uint32_t)value;
+		else if(arg == "--pdp-fail-rate") config.pdpFailRate = value;
+		else if(arg == "--stdout-stall-rate") config.stdoutStallRate = value;
+		else if(arg == "--stdout-stall-us") config.stdoutStallMicros = (uint32_t)value;
+		else if(arg == "--jump-rate") config.jumpRate = value;
+		else if(arg == "--jump-max-us") config.jumpMaxMicros = (uint32_t)value;
+		else if(arg == "--dropout-rate") config.dropoutRate = value;
+		else if(arg == "--overcurrent-rate") config.overcurrentRate = value;
+		else if(arg == "--tracking")
+		{
+			config.tracking = true;
+			continue;
+		}
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--hours H] [--seed S] [--hogs N] [--tolerance-ms T]" << std::endl
+					<< "  [--pdp-slow-rate R] [--pdp-slow-us U] [--pdp-fail-rate R] [--stdout-stall-rate R] [--stdout-stall-us U]" << std::endl
+					<< "  [--jump-rate R] [--jump-max-us U] [--dropout-rate R] [--overcurrent-rate R] [--tracking]" << std::endl
+					<< "Rates are fault episodes per simulated minute." << std::endl;
+			return 2;
+		}
+		++i;
+	}
+
+	SoakHarness harness(config);
+	return config.tracking ? harness.tracking() : harness.run();
+}
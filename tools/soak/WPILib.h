@@ -0,0 +1,125 @@
+#ifndef TOOLS_SOAK_WPILIB_H_
+#define TOOLS_SOAK_WPILIB_H_
+
+/*
+ * Simulated stand-in for the subset of WPILib used by the robot code, for the host soak harness.
+ * Every device reads from or writes to the global SimWorld, which SoakHarness.cpp advances in simulated time
+ * and uses to inject faults. Only the interfaces used in src/ are provided.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+const unsigned SIM_JOYSTICKS = 2;
+const unsigned SIM_JOYSTICK_AXES = 6;
+const unsigned SIM_JOYSTICK_BUTTONS = 12;
+const unsigned SIM_PWM_CHANNELS = 20;
+const unsigned SIM_DIO_CHANNELS = 32;
+const unsigned SIM_ANALOG_CHANNELS = 8;
+const unsigned SIM_PDP_CHANNELS = 16;
+
+struct SimWorld
+{
+	// True simulated time, and the offset the FPGA clock has been jumped by
+	uint64_t timeMicros;
+	int64_t fpgaOffsetMicros;
+
+	double axes[SIM_JOYSTICKS][SIM_JOYSTICK_AXES];
+	bool buttons[SIM_JOYSTICKS][SIM_JOYSTICK_BUTTONS];
+
+	double pwm[SIM_PWM_CHANNELS];
+	uint64_t pwmWrites;
+
+	bool dio[SIM_DIO_CHANNELS];
+	int32_t encoder[SIM_DIO_CHANNELS]; // Indexed by encoder channel A
+
+	double analogVoltage[SIM_ANALOG_CHANNELS];
+	bool analogDropout[SIM_ANALOG_CHANNELS];
+
+	double pdpCurrent[SIM_PDP_CHANNELS];
+	uint32_t pdpReadDelayMicros; // Simulated time each PDP read takes
+	bool pdpFailing; // Reads return 0, as WPILib does on a CAN error
+};
+
+extern SimWorld sim;
+
+class Timer
+{
+	public:
+		static double GetFPGATimestamp() { return (double)((int64_t)sim.timeMicros + sim.fpgaOffsetMicros) / 1000000.0; }
+};
+
+class Joystick
+{
+	public:
+		explicit Joystick(int port) : port(port) {}
+		double GetRawAxis(int axis) const { return ((unsigned)axis < SIM_JOYSTICK_AXES) ? sim.axes[port][axis] : 0; }
+		bool GetRawButton(int button) const { return ((unsigned)button < SIM_JOYSTICK_BUTTONS) ? sim.buttons[port][button] : false; }
+
+	private:
+		int port;
+};
+
+class Victor
+{
+	public:
+		explicit Victor(int channel) : channel(channel) {}
+		void Set(double speed) { sim.pwm[channel] = std::max(-1.0, std::min(1.0, speed)); ++sim.pwmWrites; }
+
+	private:
+		int channel;
+};
+
+class Encoder
+{
+	public:
+		Encoder(int channelA, int channelB) : channel(channelA) { (void)channelB; }
+		int GetRaw() const { return sim.encoder[channel]; }
+
+	private:
+		int channel;
+};
+
+class AnalogInput
+{
+	public:
+		explicit AnalogInput(int channel) : channel(channel) {}
+		void SetAverageBits(int bits) { (void)bits; }
+		void SetOversampleBits(int bits) { (void)bits; }
+		double GetAverageVoltage() const { return sim.analogDropout[channel] ? 0 : sim.analogVoltage[channel]; }
+		static void SetSampleRate(double samplesPerSecond) { (void)samplesPerSecond; }
+
+	private:
+		int channel;
+};
+
+class ControllerPower
+{
+	public:
+		static double GetVoltage5V() { return 5.0; }
+};
+
+class PowerDistributionPanel
+{
+	public:
+		double GetCurrent(int channel) const
+		{
+			sim.timeMicros += sim.pdpReadDelayMicros;
+			return sim.pdpFailing ? 0 : sim.pdpCurrent[channel];
+		}
+};
+
+class DigitalOutput
+{
+	public:
+		explicit DigitalOutput(int channel) : channel(channel) {}
+		void Set(bool value) { sim.dio[channel] = value; }
+
+	private:
+		int channel;
+};
+
+#endif /* TOOLS_SOAK_WPILIB_H_ */